@@ -54,9 +54,10 @@
 //  '__cplusplus' built-in macro constant.
 //
 // DEBUG_DRAW_MAX_*
-//  Sizes of internal intermediate buffers, which are allocated on initialization
-//  by the implementation. If you need to draw more primitives than the sizes of
-//  these buffers, you need to redefine the macros and recompile.
+//  Default maximum sizes of the internal draw queues. The queues start small and
+//  grow in chunks on demand up to these limits. The limits, initial sizes and growth
+//  step can also be set per context at runtime by passing a dd::ContextDesc to
+//  dd::initialize(), in which case these macros only provide the default values.
 //
 // DEBUG_DRAW_VERTEX_BUFFER_SIZE
 //  Size in dd::DrawVertex elements of the intermediate vertex buffer used
@@ -74,20 +75,27 @@
 //  for the Standard Library. This might be useful if you want to avoid the
 //  dependency. It is defined to zero by default (i.e. we use cmath by default).
 //
+// DEBUG_DRAW_USE_SIMD
+//  If nonzero, the vertexes of the round shapes and the point transforms are
+//  computed with SSE2, a few points at a time. Defaults to nonzero when the
+//  compiler targets SSE2, which all x86-64 builds do. Define it to zero to use
+//  the portable scalar code, which gives the same results.
+//
 // DEBUG_DRAW_*_TYPE_DEFINED
 //  The compound types used by Debug Draw can also be customized.
 //  By default, ddVec3 and ddMat4x4 are plain C-arrays, but you can
 //  redefine them to use your own classes or structures (see below).
-//  ddStr is by default a std::string, but you can redefine it to
-//  a custom string type if necessary. The only requirements are that
-//  it provides a 'c_str()' method returning a null terminated
-//  const char* string and an assignment operator (=).
+//  ddStr is no longer used to store the debug text, which is now copied
+//  into arenas owned by the context (see DEBUG_DRAW_TEXT_ARENA_SIZE), so
+//  the typedef is only kept for source compatibility. For the same reason
+//  DEBUG_DRAW_STR_DEALLOC_FUNC(str) is no longer called and can be removed.
 //
-// DEBUG_DRAW_STR_DEALLOC_FUNC(str)
-//  If you define a custom string type for ddStr and it requires some
-//  extra cleanup besides the class destructor, you might define this
-//  function macro to perform said cleanup. It is called by dd::clear()
-//  and dd::shutdown() on every instance of the internal DebugString buffer.
+// DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+//  Name of your own vertex struct, to have the points, lines and glyphs written
+//  straight into your GPU layout instead of dd::DrawVertex. It adds the format
+//  dd::VertexFormatCustom and the RenderInterface methods taking it. The type
+//  must be declared before including this file, together with a specialization
+//  of dd::VertexWriter for it (see below), and be a plain struct.
 //
 // DEBUG_DRAW_NO_DEFAULT_COLORS
 //  If defined, doesn't add the set of predefined color constants inside
@@ -112,8 +120,15 @@
 //  MEMORY ALLOCATION
 // -------------------
 // Debug Draw will only perform a couple of memory allocations during startup to decompress
-// the built-in glyph bitmap used for debug text rendering and to allocate the vertex buffers
-// and intermediate draw/batch buffers and context data used internally.
+// the built-in glyph bitmap used for debug text rendering and to allocate the context data
+// and the initial queue chunks used internally. The vertex buffer is allocated by the first
+// dd::flush() that has something to draw, unless the RenderInterface hands out its own
+// memory via acquireVertexSpace(), in which case it is never needed. So is the indexed
+// line batch, if the RenderInterface draws indexed line lists. The draw queues can also
+// grow later on, one fixed-size chunk at a time, when they fill up, and so can the arenas
+// holding the debug text and the shape geometry, which double in size when full (see
+// dd::ContextDesc). So do the vertex buffers in single-shot mode, to fit the largest
+// batch. Call dd::trim() to give that memory back after a spike.
 //
 // Memory allocation and deallocation for Debug Draw will be done via:
 //
@@ -124,6 +139,10 @@
 // By default, they are defined to use std::malloc and std::free, respectively.
 // Note: If you redefine one, you must also provide the other.
 //
+// The macros apply to all contexts. To give a context an allocator of its own,
+// e.g. a frame arena for the render thread, implement dd::Allocator and pass it
+// in dd::ContextDesc::allocator when initializing the context.
+//
 // --------------------------------
 //  INTERFACING WITH YOUR RENDERER
 // --------------------------------
@@ -147,7 +166,8 @@
 //
 // 2D screen-text is in screen-space pixels (from 0,0 in the upper-left
 // corner of the screen to screen_width-1 and screen_height-1).
-// RenderInterface::drawGlyphList() also receives vertexes in screen-space.
+// RenderInterface::drawGlyphList() also receives vertexes in screen-space,
+// and so does RenderInterface::drawGlyphInstances().
 //
 // We make some usage of matrices for things like the projected text labels.
 // Matrix layout used is column-major and vectors multiply as columns.
@@ -179,10 +199,11 @@
 #endif // DEBUG_DRAW_CXX11_SUPPORTED
 
 //
-// Max elements of each type at any given time.
+// Default max elements of each type at any given time.
 // We supply these reasonable defaults, but you can provide your
 // own tunned values to save memory or fit all of your debug data.
-// These are hard constraints. If not enough, change and recompile.
+// These are only the defaults for dd::ContextDesc::*.maxCapacity,
+// so they can also be overridden per context at runtime.
 //
 #ifndef DEBUG_DRAW_MAX_STRINGS
     #define DEBUG_DRAW_MAX_STRINGS 512
@@ -196,6 +217,46 @@
     #define DEBUG_DRAW_MAX_LINES 32768
 #endif // DEBUG_DRAW_MAX_LINES
 
+#ifndef DEBUG_DRAW_MAX_MESHES
+    #define DEBUG_DRAW_MAX_MESHES 4096
+#endif // DEBUG_DRAW_MAX_MESHES
+
+#ifndef DEBUG_DRAW_MAX_SHAPE_INSTANCES
+    #define DEBUG_DRAW_MAX_SHAPE_INSTANCES 16384
+#endif // DEBUG_DRAW_MAX_SHAPE_INSTANCES
+
+//
+// Default number of elements in each chunk of the growable draw
+// queues. A queue grows by one chunk at a time, so this also sets
+// the initial footprint of a context that uses the default dd::ContextDesc.
+//
+#ifndef DEBUG_DRAW_QUEUE_CHUNK_SIZE
+    #define DEBUG_DRAW_QUEUE_CHUNK_SIZE 1024
+#endif // DEBUG_DRAW_QUEUE_CHUNK_SIZE
+
+//
+// Default width in milliseconds of the expiry buckets. Queued elements are
+// grouped by expiration date into buckets of this width, so dd::flush() only
+// has to look at the buckets whose deadline has passed. Smaller buckets copy
+// fewer elements when they partially expire but use more chunks for timed
+// draws of varied durations. Overridden by dd::ContextDesc::expiryBucketMillis.
+//
+#ifndef DEBUG_DRAW_EXPIRY_BUCKET_MILLIS
+    #define DEBUG_DRAW_EXPIRY_BUCKET_MILLIS 64
+#endif // DEBUG_DRAW_EXPIRY_BUCKET_MILLIS
+
+//
+// Default initial size in bytes of the text arenas. The text of debug
+// strings is copied into a bump arena instead of a heap-allocated string.
+// Text drawn for a single frame is dropped after each flush by just
+// rewinding its arena, the text of timed strings goes into a second arena
+// that is compacted once it is mostly garbage. Both grow by doubling when
+// full. Overridden by dd::ContextDesc::textArenaBytes.
+//
+#ifndef DEBUG_DRAW_TEXT_ARENA_SIZE
+    #define DEBUG_DRAW_TEXT_ARENA_SIZE 4096
+#endif // DEBUG_DRAW_TEXT_ARENA_SIZE
+
 //
 // Size in vertexes of a local buffer we use to sort elements
 // drawn with and without depth testing before submitting them to
@@ -230,6 +291,18 @@
     #define DEBUG_DRAW_USE_STD_MATH 1
 #endif // DEBUG_DRAW_USE_STD_MATH
 
+//
+// SSE2 versions of the batched math kernels, if the target has it.
+// Define DEBUG_DRAW_USE_SIMD to zero to always use the scalar ones.
+//
+#ifndef DEBUG_DRAW_USE_SIMD
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define DEBUG_DRAW_USE_SIMD 1
+    #else // !SSE2
+        #define DEBUG_DRAW_USE_SIMD 0
+    #endif // SSE2
+#endif // DEBUG_DRAW_USE_SIMD
+
 // ========================================================
 // Overridable Debug Draw types:
 // ========================================================
@@ -296,11 +369,8 @@
 
 #ifndef DEBUG_DRAW_STRING_TYPE_DEFINED
     // ddStr:
-    //  String type used internally to store the debug text strings.
-    //  A custom string type must provide at least an assignment
-    //  operator (=) and a 'c_str()' method that returns a
-    //  null-terminated const char* string pointer. That's it.
-    //  An array subscript operator [] is not required for ddStr.
+    //  No longer used internally, debug text is copied into the
+    //  context text arenas. Kept for source compatibility only.
     #include <string>
     typedef std::string   ddStr;
     typedef const ddStr & ddStr_In;
@@ -501,6 +571,44 @@ void line(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
           int durationMillis = 0,
           bool depthEnabled = true);
 
+// Bulk versions of dd::point() and dd::line(), and of dd::aabb() and dd::sphere() below,
+// for large numbers of elements kept in your own arrays. They are much cheaper than
+// calling the single element functions in a loop: the checks, the color conversion of a
+// shared color and the queue bookkeeping are done once per chunk of elements.
+// Element i reads its XYZ positions at 'i * stride' bytes into the position arrays,
+// which can point into arrays of structs, and its RGB color at 'i * colorStride' bytes
+// into 'colors'. A 'colorStride' of zero draws them all with the first color.
+// Return the number of elements queued, less than 'count' if the queues filled up.
+int points(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+           const float * positions,
+           int stride,
+           int count,
+           const float * colors,
+           int colorStride,
+           float size = 1.0f,
+           int durationMillis = 0,
+           bool depthEnabled = true);
+
+int lines(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+          const float * from,
+          const float * to,
+          int stride,
+          int count,
+          const float * colors,
+          int colorStride,
+          int durationMillis = 0,
+          bool depthEnabled = true);
+
+// Add a line strip through 'count' points to the debug draw queue, e.g. a path
+// or a trajectory. Each point is stored and submitted once, so this is a lot
+// cheaper than drawing the segments with dd::line(). Needs at least two points.
+void polyline(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+              const ddVec3 * points,
+              int count,
+              ddVec3_In color,
+              int durationMillis = 0,
+              bool depthEnabled = true);
+
 // Add a 2D text string as an overlay to the current view, using a built-in font.
 // Position is in screen-space pixels, origin at the top-left corner of the screen.
 // The third element (Z) of the position vector is ignored.
@@ -584,6 +692,33 @@ void sphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
             int durationMillis = 0,
             bool depthEnabled = true);
 
+// Add a wireframe sphere with 'numRings' rings of latitude between the poles and
+// 'numSegments' meridians, which also split each ring, to the debug draw queue.
+// Each edge is drawn once; dd::sphere() is the same with 11 rings and 24 segments.
+// The counts are limited to 1-63 rings and 3-128 segments, and the level of
+// detail set by dd::setLodTolerance() does not reduce them.
+void latLongSphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+                   ddVec3_In center,
+                   ddVec3_In color,
+                   float radius,
+                   int numRings,
+                   int numSegments,
+                   int durationMillis = 0,
+                   bool depthEnabled = true);
+
+// Bulk version of dd::sphere(), see dd::lines(). Radius i is the float
+// at 'i * radiusStride' bytes into 'radii', a zero stride shares the first.
+int spheres(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+            const float * centers,
+            int centerStride,
+            const float * radii,
+            int radiusStride,
+            int count,
+            const float * colors,
+            int colorStride,
+            int durationMillis = 0,
+            bool depthEnabled = true);
+
 // Add a wireframe cone to the debug draw queue.
 // The cone 'apex' is the point where all lines meet.
 // The length of the 'dir' vector determines the thickness.
@@ -622,6 +757,17 @@ void aabb(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
           int durationMillis = 0,
           bool depthEnabled = true);
 
+// Bulk version of dd::aabb(), see dd::lines().
+int aabbs(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+          const float * mins,
+          const float * maxs,
+          int stride,
+          int count,
+          const float * colors,
+          int colorStride,
+          int durationMillis = 0,
+          bool depthEnabled = true);
+
 // Add a wireframe frustum pyramid to the debug draw queue.
 // 'invClipMatrix' is the inverse of the matrix defining the frustum
 // (AKA clip) volume, which normally consists of the projection * view matrix.
@@ -704,6 +850,80 @@ union DrawVertex
     } glyph;
 };
 
+//
+// Optional compact vertex formats for points and lines, selected
+// per context with dd::ContextDesc::vertexFormat. Colors are packed
+// as RGBA8 in a 32-bit word with red in the lowest byte, so they are
+// R,G,B,A in memory on little-endian machines. Alpha is always 255.
+// Text glyphs always use the DrawVertex layout.
+//
+enum VertexFormat
+{
+    VertexFormatDefault,     // DrawVertex (28 bytes) via drawPointList()/drawLineList().
+    VertexFormatCompact,     // CompactPointVertex (20 bytes) and CompactVertex (16 bytes).
+    VertexFormatCompactHalf, // HalfVertex (12 bytes) for both points and lines.
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    VertexFormatCustom       // CustomVertex for points, lines and glyphs, written by VertexWriter<CustomVertex>.
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+};
+
+struct CompactVertex
+{
+    float x, y, z;
+    std::uint32_t color;
+};
+
+struct CompactPointVertex
+{
+    float x, y, z;
+    std::uint32_t color;
+    float size;
+};
+
+// Position and point size are IEEE 754 half-precision
+// floats (binary16). Size is always zero for lines.
+struct HalfVertex
+{
+    std::uint16_t x, y, z;
+    std::uint16_t size;
+    std::uint32_t color;
+};
+
+//
+// Writes one vertex of a user layout, for DEBUG_DRAW_CUSTOM_VERTEX_TYPE.
+// Specialize it for your vertex type before including this file:
+//
+//   struct MyVertex { float pos[3]; std::uint32_t rgba; float uvOrSize[2]; };
+//   namespace dd { template<typename V> struct VertexWriter; template<> struct VertexWriter<MyVertex>
+//   {
+//       static void writePoint(MyVertex & out, const float pos[3], std::uint32_t color, float size);
+//       static void writeLine(MyVertex & out, const float pos[3], std::uint32_t color);
+//       static void writeGlyph(MyVertex & out, float x, float y, float u, float v, std::uint32_t color);
+//   }; }
+//   #define DEBUG_DRAW_CUSTOM_VERTEX_TYPE MyVertex
+//
+// The functions are called from the expansion loops for every vertex, so define
+// them inline. Colors are packed RGBA8 like in the compact formats. Glyphs are in
+// screen-space pixels, with 'u' and 'v' the texture coordinates.
+//
+template<typename V> struct VertexWriter;
+
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+typedef DEBUG_DRAW_CUSTOM_VERTEX_TYPE CustomVertex;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+//
+// Kind of primitive in a batch of vertexes, for the
+// dd::RenderInterface::acquireVertexSpace() path.
+//
+enum DrawMode
+{
+    DrawModePoints,    // One vertex per point, in the context vertex format.
+    DrawModeLines,     // Two vertexes per line, in the context vertex format.
+    DrawModeText,      // Six DrawVertex glyph vertexes (two triangles) per character, CustomVertex with VertexFormatCustom.
+    DrawModePointQuads // Six vertexes (two triangles) per point, in the line vertex layout.
+};
+
 //
 // Opaque handle to a texture object.
 // Used by the debug text drawing functions.
@@ -711,6 +931,55 @@ union DrawVertex
 struct OpaqueTextureType { };
 typedef OpaqueTextureType * GlyphTextureHandle;
 
+//
+// One character of debug text, for RenderInterface::drawGlyphInstances().
+// The quad covers the screen-space rectangle from (x, y) to (x + texelWidth * scale,
+// y + texelHeight * scale), mapped to the glyph texture rectangle that starts at
+// texel (texelX, texelY). The texture coordinates drawGlyphList() gets for it are
+// u0 = (texelX + 0.5) / textureWidth and u1 = u0 + texelWidth / textureWidth,
+// and likewise for V. The color is packed like CompactVertex::color.
+//
+struct GlyphInstance
+{
+    float x, y;
+    std::uint16_t texelX, texelY;
+    std::uint16_t texelWidth, texelHeight;
+    float scale;
+    std::uint32_t color;
+};
+
+//
+// Unit wireframe meshes for the shapes that can be drawn instanced,
+// see dd::RenderInterface::createShapeMesh().
+//
+enum ShapeMesh
+{
+    ShapeMeshSphere, // Radius 1, centered at the origin.
+    ShapeMeshBox,    // Cube from -0.5 to +0.5 in each axis.
+    ShapeMeshCone,   // Apex at the origin, base circle of radius 1 on the Z=1 plane.
+    ShapeMeshCount
+};
+
+//
+// One instance of a unit shape mesh. 'transform' is a 3x4 row-major matrix,
+// so a unit mesh position P ends up at:
+//   x = t[0] * P.x + t[1] * P.y + t[2]  * P.z + t[3]
+//   y = t[4] * P.x + t[5] * P.y + t[6]  * P.z + t[7]
+//   z = t[8] * P.x + t[9] * P.y + t[10] * P.z + t[11]
+// The color is packed like CompactVertex::color.
+//
+struct ShapeInstance
+{
+    float transform[12];
+    std::uint32_t color;
+};
+
+//
+// Opaque handle to a unit shape mesh owned by the renderer.
+//
+struct OpaqueShapeMeshType { };
+typedef OpaqueShapeMeshType * ShapeMeshHandle;
+
 // ========================================================
 // Debug Draw rendering callbacks:
 // Implementation is provided by the user so we don't
@@ -751,10 +1020,187 @@ public:
     virtual void drawLineList(const DrawVertex * lines, int count, bool depthEnabled);
     virtual void drawGlyphList(const DrawVertex * glyphs, int count, GlyphTextureHandle glyphTex);
 
+    //
+    // Optional instanced text. Each GlyphInstance is one character quad, to be drawn
+    // with the glyph texture, for a sixth of the vertex data of drawGlyphList(). Return
+    // true if the glyphs were drawn. The default implementation returns false, after
+    // which the library stops calling it and uses drawGlyphList() instead.
+    //
+    virtual bool drawGlyphInstances(const GlyphInstance * glyphs, int count, GlyphTextureHandle glyphTex);
+
+    //
+    // Same as the above, but called instead of drawPointList()/drawLineList() when the
+    // context uses one of the compact vertex formats (see dd::ContextDesc::vertexFormat).
+    // You only have to override the pair matching the format you have selected.
+    //
+    virtual void drawPointListCompact(const CompactPointVertex * points, int count, bool depthEnabled);
+    virtual void drawLineListCompact(const CompactVertex * lines, int count, bool depthEnabled);
+    virtual void drawPointListHalf(const HalfVertex * points, int count, bool depthEnabled);
+    virtual void drawLineListHalf(const HalfVertex * lines, int count, bool depthEnabled);
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    // With VertexFormatCustom, glyphs come in the custom layout as well.
+    virtual void drawPointListCustom(const CustomVertex * points, int count, bool depthEnabled);
+    virtual void drawLineListCustom(const CustomVertex * lines, int count, bool depthEnabled);
+    virtual void drawGlyphListCustom(const CustomVertex * glyphs, int count, GlyphTextureHandle glyphTex);
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    //
+    // Points expanded into camera facing quads, for renderers that can't size points
+    // per vertex. Called instead of the point list methods when dd::ContextDesc::pointQuads
+    // is set and dd::setCamera() was given a camera. The vertexes are a triangle list, two
+    // triangles per point covering 'size' by 'size' pixels, in the line vertex layout of the
+    // context format. Note that the CompactPointVertex of drawPointListCompact() already
+    // is a compact point instance (position, size and color) for renderers that can
+    // draw the quads on the GPU instead.
+    //
+    virtual void drawPointQuads(const DrawVertex * verts, int count, bool depthEnabled);
+    virtual void drawPointQuadsCompact(const CompactVertex * verts, int count, bool depthEnabled);
+    virtual void drawPointQuadsHalf(const HalfVertex * verts, int count, bool depthEnabled);
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    virtual void drawPointQuadsCustom(const CustomVertex * verts, int count, bool depthEnabled);
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    //
+    // Optional indexed line lists, used for the shapes with shared vertexes (spheres,
+    // boxes, cones, capsules, frustums). 'verts' holds the unique vertexes of a batch
+    // of shapes, in the context vertex format, and each pair of 16-bit 'indexes' into
+    // it is a line. Return true if the batch was drawn. The default implementations
+    // return false, after which the library stops calling these and expands the shapes
+    // into plain line lists instead. Only the method matching the context vertex format
+    // is called. Indexed batches always come from internal memory, never from
+    // acquireVertexSpace().
+    //
+    virtual bool drawIndexedLineList(const DrawVertex * verts, int vertexCount,
+                                     const std::uint16_t * indexes, int indexCount, bool depthEnabled);
+    virtual bool drawIndexedLineListCompact(const CompactVertex * verts, int vertexCount,
+                                            const std::uint16_t * indexes, int indexCount, bool depthEnabled);
+    virtual bool drawIndexedLineListHalf(const HalfVertex * verts, int vertexCount,
+                                         const std::uint16_t * indexes, int indexCount, bool depthEnabled);
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    virtual bool drawIndexedLineListCustom(const CustomVertex * verts, int vertexCount,
+                                           const std::uint16_t * indexes, int indexCount, bool depthEnabled);
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    //
+    // Optional line strips, used for dd::polyline(). Each call draws a single strip
+    // through 'count' vertexes in the context vertex format, e.g. as a GL_LINE_STRIP.
+    // Return true if the strip was drawn. The default implementations return false,
+    // after which the library stops calling these and expands the polylines into plain
+    // line lists instead. Only the method matching the context vertex format is called.
+    // Polylines longer than the vertex buffer are split into strips sharing end vertexes.
+    //
+    virtual bool drawLineStrip(const DrawVertex * verts, int count, bool depthEnabled);
+    virtual bool drawLineStripCompact(const CompactVertex * verts, int count, bool depthEnabled);
+    virtual bool drawLineStripHalf(const HalfVertex * verts, int count, bool depthEnabled);
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    virtual bool drawLineStripCustom(const CustomVertex * verts, int count, bool depthEnabled);
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    //
+    // Optional instanced shapes. On startup, createShapeMesh() is called once for each
+    // dd::ShapeMesh with the unit wireframe, as 'vertexCount' XYZ positions and pairs
+    // of 16-bit 'indexes' forming lines. If it returns non-null, spheres, boxes, AABBs
+    // and pointed cones of that kind are queued as a ShapeInstance each, and drawn with
+    // drawShapeInstances(), which should draw the mesh once per instance. Otherwise,
+    // the default, they are expanded into lines on the CPU. destroyShapeMesh() is called
+    // by dd::shutdown() for each mesh created.
+    //
+    virtual ShapeMeshHandle createShapeMesh(ShapeMesh shape, const float * positions, int vertexCount,
+                                            const std::uint16_t * indexes, int indexCount);
+    virtual void destroyShapeMesh(ShapeMeshHandle mesh);
+    virtual void drawShapeInstances(ShapeMeshHandle mesh, const ShapeInstance * instances, int count, bool depthEnabled);
+
+    //
+    // Optional persistent ranges, for lines drawn with a duration. Timed lines are grouped
+    // by expiry date, and each group is handed over as a range with a stable 'id' and a
+    // 'version' that changes whenever lines get added to or removed from it. When a range
+    // is new or has changed, 'verts' holds its 'count' vertexes in the context line layout
+    // (as in acquireVertexSpace()), to be kept on the GPU and drawn. While it stays the same
+    // on later frames, 'verts' is null and the kept copy should be drawn again, so long-lived
+    // lines are only expanded and uploaded once. releasePersistentRange() is called when a
+    // range is gone, ids are never reused. Return true if the range was drawn. The default
+    // returns false, after which the library stops calling it and draws the timed lines in
+    // the line lists with the others.
+    //
+    virtual bool drawPersistentRange(std::uint32_t id, std::uint32_t version, const void * verts, int count, bool depthEnabled);
+    virtual void releasePersistentRange(std::uint32_t id);
+
+    //
+    // Optional zero-copy path. Before writing a batch of vertexes, the library calls
+    // acquireVertexSpace(). If it returns non-null, the vertexes are expanded straight
+    // into that memory, which must have room for 'maxCount' vertexes of the format
+    // matching 'mode' (see dd::DrawMode), e.g. a persistently mapped GPU buffer. The
+    // batch is then handed back with commitVertexSpace(), with the number of vertexes
+    // actually written, instead of a draw*List() call. Only one batch is acquired at a
+    // time. The default acquireVertexSpace() returns null, in which case the vertexes
+    // are written to an internal buffer and passed to the draw*List() methods above.
+    // Glyph batches should be drawn with the texture from createGlyphTexture().
+    // 'maxCount' is DEBUG_DRAW_VERTEX_BUFFER_SIZE, or in single-shot mode (see
+    // dd::ContextDesc::singleShot) the vertex count of the whole bucket, which
+    // can be a lot larger.
+    //
+    virtual void * acquireVertexSpace(DrawMode mode, bool depthEnabled, int maxCount);
+    virtual void commitVertexSpace(DrawMode mode, bool depthEnabled, int count);
+
+    //
+    // Optional asynchronous consumption of our vertex buffers. If the context has more than
+    // one staging buffer (see dd::ContextDesc::stagingBuffers), the renderer may keep reading
+    // the data passed to a draw*List(), drawLineStrip*(), drawIndexedLineList*() or
+    // drawGlyphInstances() call after it returns, e.g. for an upload on another thread, while
+    // the library fills the next buffer. Before writing to a buffer again, or freeing it, the
+    // library calls waitBufferConsumed() with the pointer it last passed from that buffer, which
+    // must only return once the renderer is done with it. For indexed line lists that is the
+    // vertex pointer, and the wait covers the indexes passed with it too. The default returns
+    // right away, for renderers that read the data within the call.
+    //
+    virtual void waitBufferConsumed(const void * verts);
+
     // User defined cleanup. Nothing by default.
     virtual ~RenderInterface() = 0;
 };
 
+// ========================================================
+// Optional per-context memory allocator:
+// ========================================================
+
+//
+// All memory owned by a context (the context itself, the draw queues,
+// the text arenas, the vertex buffer and the temporary font bitmap) is
+// allocated through the dd::ContextDesc::allocator given to dd::initialize(),
+// so that each context can use a different allocator. The defaults go
+// through the global DD_MALLOC/DD_MFREE macros. The allocator object must
+// remain valid until after dd::shutdown() is called for its context.
+//
+class Allocator
+{
+public:
+
+    //
+    // Returns a block of at least 'size' bytes aligned to 'alignment', or null
+    // if out of memory. Alignment is a power of two, never greater than 16.
+    // The default implementation calls DD_MALLOC, which is expected to return
+    // blocks aligned for any fundamental type, like std::malloc does.
+    //
+    virtual void * allocate(std::size_t size, std::size_t alignment);
+
+    //
+    // Frees a block returned by allocate() or reallocate(). 'size' is the size
+    // that was requested for it. Never called with a null pointer. The default
+    // implementation calls DD_MFREE.
+    //
+    virtual void deallocate(void * ptr, std::size_t size);
+
+    //
+    // Resizes a block returned by allocate(), keeping the first min(oldSize, newSize)
+    // bytes. On failure, returns null and leaves the block untouched. The default
+    // implementation allocates a new block, copies and frees the old one.
+    //
+    virtual void * reallocate(void * ptr, std::size_t oldSize, std::size_t newSize, std::size_t alignment);
+
+    // User defined cleanup. Nothing by default.
+    virtual ~Allocator();
+};
+
 // ========================================================
 // Housekeeping functions:
 // ========================================================
@@ -768,11 +1214,78 @@ enum FlushFlags
     FlushAll    = (FlushPoints | FlushLines | FlushText)
 };
 
+// Sizing and growth policy of a single draw queue. Capacities are in queue
+// elements (lines, points, strings or meshes). The queue starts with 'initialCapacity'
+// elements allocated and grows on demand, one chunk of 'chunkCapacity' elements
+// at a time, until it holds 'maxCapacity' elements. Chunks are never moved or
+// reallocated once written to. A 'maxCapacity' of zero lets the queue grow for
+// as long as DD_MALLOC succeeds. Timed draws are grouped by expiry date (see
+// dd::ContextDesc::expiryBucketMillis) into chunks of a 16th of 'chunkCapacity',
+// at least 16 elements, so the limit holds however their dates are spread.
+struct QueueDesc
+{
+    int initialCapacity;
+    int chunkCapacity;
+    int maxCapacity;
+};
+
+// Optional creation parameters for dd::initialize().
+// The default constructor fills in the library defaults, so you
+// only have to override the fields you care about.
+struct ContextDesc
+{
+    QueueDesc lines;
+    QueueDesc points;
+    QueueDesc strings;
+
+    // Shapes with shared vertexes (spheres, boxes, cones, capsules, frustums)
+    // and polylines are queued as a single line mesh each, with their geometry
+    // kept in arenas that start empty and grow like the text arenas.
+    QueueDesc meshes;
+
+    // Shapes drawn with RenderInterface::drawShapeInstances() instead.
+    QueueDesc shapeInstances;
+
+    // Width of the expiry buckets timed elements are sorted into.
+    // Elements of a bucket share chunks and get removed together.
+    int expiryBucketMillis;
+
+    // Vertex layout handed to the RenderInterface for points and lines.
+    VertexFormat vertexFormat;
+
+    // Initial size in bytes of each of the two text arenas, the one
+    // for single frame strings and the one for timed strings.
+    int textArenaBytes;
+
+    // Where the context memory comes from. Null to use DD_MALLOC/DD_MFREE.
+    Allocator * allocator;
+
+    // Draw points as quads, see RenderInterface::drawPointQuads().
+    bool pointQuads;
+
+    // Number of vertex buffers rotated between draw calls, from 1 to 8. Indexed
+    // line and glyph instance batches rotate through as many buffers of their own.
+    // See RenderInterface::waitBufferConsumed().
+    int stagingBuffers;
+
+    // Hand over each bucket of point, line or text vertexes (one per primitive and
+    // depth test setting) in a single draw*List() call, or a single acquireVertexSpace()
+    // of the exact size, instead of batches of DEBUG_DRAW_VERTEX_BUFFER_SIZE. The vertex
+    // buffers grow to fit the largest bucket, dd::trim() gives the memory back. Indexed
+    // meshes, line strips and shape instances still split the lines of their depth
+    // bucket where they have to be drawn in between, to keep the priority order.
+    bool singleShot;
+
+    ContextDesc();
+};
+
 // Initialize with the user-supplied renderer interface.
 // Given object must remain valid until after dd::shutdown() is called!
 // If 'renderer' is null, the Debug Draw functions become no-ops, but
-// can still be safely called.
-bool initialize(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle * outCtx,) RenderInterface * renderer);
+// can still be safely called. 'desc' is optional and may be null, in
+// which case the defaults of dd::ContextDesc are used.
+bool initialize(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle * outCtx,) RenderInterface * renderer,
+                const ContextDesc * desc = nullptr);
 
 // After this is called, it is safe to dispose the dd::RenderInterface instance
 // you passed to dd::initialize(). Shutdown will also attempt to free the glyph texture.
@@ -788,6 +1301,11 @@ bool hasPendingDraws(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx));
 // This is not normally called. To draw stuff, call dd::flush() instead.
 void clear(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx));
 
+// Frees the memory the queues and text arenas grew into that is no longer in use,
+// going back to the initial sizes from dd::ContextDesc. Queued draws are kept.
+// Meant to be called once in a while, e.g. after a spike of debug draws.
+void trim(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx));
+
 // Actually calls the dd::RenderInterface to consume the debug draw queues.
 // Objects that have expired their lifetimes get removed. Pass the current
 // application time in milliseconds to remove timed objects that have expired.
@@ -796,6 +1314,67 @@ void flush(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
            std::int64_t currTimeMillis = 0,
            std::uint32_t flags = FlushAll);
 
+// Sets the camera of the view being drawn, for the draws that depend on it, like points
+// drawn as quads (see dd::ContextDesc::pointQuads). 'viewProjMatrix' is the projection *
+// view matrix and the viewport size is in pixels. Kept until set again.
+void setCamera(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
+               ddMat4x4_In viewProjMatrix,
+               int viewportWidth,
+               int viewportHeight);
+
+// Enables the level of detail of the round shapes: dd::sphere(), dd::circle(), dd::cone(),
+// dd::capsule() and the heads of dd::arrow(). They then use the fewest segments that keep
+// each line within 'maxErrorPixels' of the curve it stands for on screen, as seen by the
+// camera of dd::setCamera(). Zero, the default, always draws them at full detail, as do
+// shapes drawn with RenderInterface::drawShapeInstances() and shapes with no camera set.
+// Timed shapes keep the detail picked when they were queued.
+void setLodTolerance(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) float maxErrorPixels);
+
+// Priority of queued draws. When a queue is full and can't grow any
+// further, a new draw evicts the queued ones of the lowest priority below
+// its own, starting with those that expire first. If there is nothing of
+// lower priority to evict, the new draw is dropped instead.
+enum DrawPriority
+{
+    DrawPriorityLow,
+    DrawPriorityNormal,
+    DrawPriorityHigh,
+    DrawPriorityCount
+};
+
+// Sets the priority of all draws queued after this call, so each subsystem can
+// set its own before drawing. The initial priority is DrawPriorityNormal.
+void setDrawPriority(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) DrawPriority priority);
+DrawPriority getDrawPriority(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx));
+
+// Number of queued elements evicted to make room for higher priority
+// draws and of new elements dropped because the queues were full.
+// Counted from dd::initialize(). Polylines and the shapes queued as line
+// meshes or instances count as one mesh each, the others count as their lines.
+struct EvictionStats
+{
+    std::int64_t evictedPoints;
+    std::int64_t evictedLines;
+    std::int64_t evictedStrings;
+    std::int64_t evictedMeshes;
+    std::int64_t droppedPoints;
+    std::int64_t droppedLines;
+    std::int64_t droppedStrings;
+    std::int64_t droppedMeshes;
+};
+
+void getEvictionStats(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) EvictionStats * stats);
+
+// Lines left out by the level of detail of dd::setLodTolerance() and the
+// number of shapes drawn with less than full detail. Counted from dd::initialize().
+struct LodStats
+{
+    std::int64_t linesSaved;
+    std::int64_t reducedShapes;
+};
+
+void getLodStats(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) LodStats * stats);
+
 } // namespace dd
 
 // ================== End of header file ==================
@@ -821,6 +1400,10 @@ void flush(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,)
     #include <float.h>
 #endif // DEBUG_DRAW_USE_STD_MATH
 
+#if DEBUG_DRAW_USE_SIMD
+    #include <emmintrin.h>
+#endif // DEBUG_DRAW_USE_SIMD
+
 namespace dd
 {
 
@@ -1779,7 +2362,7 @@ static int lzwDecompress(const void * compressedData, int compressedSizeBytes,
 static inline const std::uint8_t * getRawFontBitmapData() { return s_fontMonoid18Bitmap;  }
 static inline const FontCharSet  & getFontCharSet()       { return s_fontMonoid18CharSet; }
 
-static std::uint8_t * decompressFontBitmap()
+static std::uint8_t * decompressFontBitmap(Allocator & allocator)
 {
     const std::uint32_t * compressedData = reinterpret_cast<const std::uint32_t *>(getRawFontBitmapData());
 
@@ -1790,7 +2373,7 @@ static std::uint8_t * decompressFontBitmap()
 
     // Allocate the decompression buffer:
     const int uncompressedSizeBytes = getFontCharSet().bitmapDecompressSize;
-    std::uint8_t * uncompressedData = static_cast<std::uint8_t *>(DD_MALLOC(uncompressedSizeBytes));
+    std::uint8_t * uncompressedData = static_cast<std::uint8_t *>(allocator.allocate(uncompressedSizeBytes, 1));
 
     // Out of memory? Font rendering will be disable.
     if (uncompressedData == nullptr)
@@ -1808,11 +2391,11 @@ static std::uint8_t * decompressFontBitmap()
     // Unexpected decompression size? Probably a data mismatch in the font-tool.
     if (bytesDecoded != uncompressedSizeBytes)
     {
-        DD_MFREE(uncompressedData);
+        allocator.deallocate(uncompressedData, uncompressedSizeBytes);
         return nullptr;
     }
 
-    // Must later free with DD_MFREE().
+    // Must later free with allocator.deallocate().
     return uncompressedData;
 }
 
@@ -1822,129 +2405,532 @@ static std::uint8_t * decompressFontBitmap()
 
 struct DebugString
 {
-    std::int64_t expiryDateMillis;
     ddVec3       color;
     float        posX;
     float        posY;
     float        scaling;
-    ddStr        text;
+    int          textOffset; // Null-terminated text in one of the context text arenas.
+    int          textLength; // Not counting the terminator.
     bool         centered;
 };
 
-struct DebugPoint
+//
+// Bump allocator for the variable-length data of queued elements: the text
+// of the debug strings and the geometry of the line meshes. Elements refer to
+// their data by offset, so the arena can be reallocated when it grows. The
+// context has one arena of each kind for the elements in the transient lists
+// of the queues, which is rewound once the lists are emptied by a flush, and
+// one for the timed elements, which is compacted when it becomes more than
+// half garbage.
+//
+struct Arena
 {
-    std::int64_t expiryDateMillis;
-    ddVec3       position;
-    ddVec3       color;
-    float        size;
-    bool         depthEnabled;
+    char * data;     // Element data, back to back.
+    int    used;     // Bytes in use, including the garbage of expired elements.
+    int    capacity; // Bytes allocated.
 };
 
-struct DebugLine
+//
+// Growable draw queue. Elements are stored in singly linked lists of
+// fixed-size chunks which are never moved once allocated. Chunks come from
+// a ChunkPool, where the ones no longer in use are kept in a free list for
+// reuse and only released when the context is shut down. Lines and points
+// have one queue per depth test setting, so that each can be drawn in a single
+// pass without testing a flag per element, and all types have one queue per
+// dd::DrawPriority. Queues of the same type share a pool, so when it runs dry
+// a high priority queue can take chunks away from a lower priority one.
+//
+// Elements drawn with a zero duration are transient: they go to a chunk list
+// of their own that is recycled whole after every flush, without looking at
+// the elements. Timed elements are grouped by expiration date into buckets,
+// each with its own list of smaller chunks, so that the many buckets holding
+// just a few elements don't tie up a large chunk each. In every list only the
+// tail chunk may be partially filled. The limits of the queues count elements,
+// not chunks, so how the dates spread over buckets doesn't matter. The buckets are kept sorted by date, so the expiry pass
+// after a flush recycles whole buckets that are past their deadline, compacts
+// the one bucket that is partially expired, and never looks at the later ones.
+// Long-lived elements are written once and never copied until their bucket
+// expires.
+//
+// Inside a chunk, elements are laid out as a structure of arrays: each
+// field lives in its own 16-byte aligned stream following the chunk header.
+// This way vertex expansion and the expiry pass only touch the bytes they
+// need and are friendly to auto-vectorization. The *Streams views below
+// map the streams of a chunk from its address and the queue chunk capacity.
+//
+struct QueueChunk
 {
-    std::int64_t expiryDateMillis;
-    ddVec3       posFrom;
-    ddVec3       posTo;
-    ddVec3       color;
-    bool         depthEnabled;
+    QueueChunk * next;     // Next chunk in the bucket or in the free list.
+    int          count;    // Number of elements in use. Element streams follow the header.
+    int          capacity; // Number of elements the streams have room for.
 };
 
-struct InternalContext DD_EXPLICIT_CONTEXT_ONLY(: public OpaqueContextType)
+struct QueueBucket
 {
-    int                vertexBufferUsed;
-    int                debugStringsCount;
-    int                debugPointsCount;
-    int                debugLinesCount;
-    std::int64_t       currentTimeMillis;                           // Latest time value (in milliseconds) from dd::flush().
-    GlyphTextureHandle glyphTexHandle;                              // Our built-in glyph bitmap. If kept null, no text is rendered.
-    RenderInterface *  renderInterface;                             // Ref to the external renderer. Can be null for a no-op debug draw.
-    DrawVertex         vertexBuffer[DEBUG_DRAW_VERTEX_BUFFER_SIZE]; // Vertex buffer we use to expand the lines/points before calling on RenderInterface.
-    DebugString        debugStrings[DEBUG_DRAW_MAX_STRINGS];        // Debug strings queue (2D screen-space strings + 3D projected labels).
-    DebugPoint         debugPoints[DEBUG_DRAW_MAX_POINTS];          // 3D debug points queue.
-    DebugLine          debugLines[DEBUG_DRAW_MAX_LINES];            // 3D debug lines queue.
+    std::int64_t  key;          // Expiry date divided by the bucket width.
+    std::int64_t  minExpiry;    // Earliest expiry date of the elements in this bucket.
+    std::int64_t  maxExpiry;    // Latest expiry date of the elements in this bucket.
+    QueueChunk *  head;         // First chunk with queued elements.
+    QueueChunk *  tail;         // Last chunk, where new elements get appended.
+    int           count;        // Number of elements in this bucket.
+    std::uint32_t version;      // Bumped whenever elements are added or removed.
+    std::uint32_t rangeId;      // Persistent range of the renderer holding these lines. Zero if none.
+    std::uint32_t rangeVersion; // Version last handed over to the renderer for that range.
+};
 
-    InternalContext(RenderInterface * renderer)
-        : vertexBufferUsed(0)
-        , debugStringsCount(0)
-        , debugPointsCount(0)
-        , debugLinesCount(0)
-        , currentTimeMillis(0)
-        , glyphTexHandle(nullptr)
-        , renderInterface(renderer)
-    { }
+struct ChunkPool
+{
+    Allocator  * allocator;           // Context allocator, also used for the bucket arrays of the queues.
+    QueueChunk * freeList;            // Allocated chunks of 'chunkCapacity' elements not currently in use.
+    QueueChunk * bucketFreeList;      // Same for the chunks of 'bucketChunkCapacity' elements.
+    int          chunkCapacity;       // Elements per chunk of the transient lists.
+    int          bucketChunkCapacity; // Elements per chunk of the expiry buckets, a lot smaller.
+    int          numChunks;           // Chunks of 'chunkCapacity' allocated so far, in use or free.
+    int          minChunks;           // Initial allocation, which dd::trim() never goes below.
+    int          count;               // Elements queued in all the queues sharing the pool.
+    int          maxCount;            // Element limit. Zero if unbounded.
 };
 
-// ========================================================
-// Library context mode selection:
-// ========================================================
+struct DebugQueue
+{
+    ChunkPool   * pool;         // Where chunks are taken from and given back to.
+    QueueBucket   transient;    // Zero-duration elements, dropped after every flush.
+    QueueBucket * buckets;      // Non-empty buckets of timed elements, sorted by key.
+    std::int64_t  bucketMillis; // Width of each bucket in milliseconds.
+    int           numBuckets;   // Buckets in use.
+    int           maxBuckets;   // Size of the buckets array.
+    int           lastBucket;   // Bucket of the latest push. Usually the next push goes there too.
+    int           count;        // Total number of elements queued, transient and timed.
+};
 
-#if (defined(DEBUG_DRAW_PER_THREAD_CONTEXT) && defined(DEBUG_DRAW_EXPLICIT_CONTEXT))
-    #error "DEBUG_DRAW_PER_THREAD_CONTEXT and DEBUG_DRAW_EXPLICIT_CONTEXT are mutually exclusive!"
-#endif // DEBUG_DRAW_PER_THREAD_CONTEXT && DEBUG_DRAW_EXPLICIT_CONTEXT
+// Chunk header is padded so that the first stream starts at a 16 bytes boundary.
+static const int QueueChunkHeaderSize = static_cast<int>((sizeof(QueueChunk) + 15) & ~15);
 
-#if defined(DEBUG_DRAW_EXPLICIT_CONTEXT)
-    //
-    // Explicit context passed as argument
-    //
-    #define DD_CONTEXT static_cast<InternalContext *>(ctx)
-#elif defined(DEBUG_DRAW_PER_THREAD_CONTEXT)
-    //
-    // Per-thread global context (MT safe)
-    //
-    #if defined(__GNUC__) || defined(__clang__) // GCC/Clang
-        #define DD_THREAD_LOCAL static __thread
-    #elif defined(_MSC_VER) // Visual Studio
-        #define DD_THREAD_LOCAL static __declspec(thread)
-    #else // Try C++11 thread_local
-        #if DEBUG_DRAW_CXX11_SUPPORTED
-            #define DD_THREAD_LOCAL static thread_local
-        #else // !DEBUG_DRAW_CXX11_SUPPORTED
-            #error "Unsupported compiler - unknown TLS model"
-        #endif // DEBUG_DRAW_CXX11_SUPPORTED
-    #endif // TLS model
-    DD_THREAD_LOCAL InternalContext * s_threadContext = nullptr;
-    #define DD_CONTEXT s_threadContext
-    #undef DD_THREAD_LOCAL
-#else // Debug Draw context selection
-    //
-    // Global static context (single threaded operation)
-    //
-    static InternalContext * s_globalContext = nullptr;
-    #define DD_CONTEXT s_globalContext
-#endif // Debug Draw context selection
+// Size in bytes of a stream of 'count' elements, padded to keep the next stream 16-byte aligned.
+template<typename T>
+static inline int streamBytes(const int count)
+{
+    return static_cast<int>((sizeof(T) * count + 15) & ~15);
+}
 
-// ========================================================
+// Returns the stream starting at 'cursor' and advances the cursor past it.
+template<typename T>
+static inline T * nextStream(std::uint8_t *& cursor, const int count)
+{
+    T * stream = reinterpret_cast<T *>(cursor);
+    cursor += streamBytes<T>(count);
+    return stream;
+}
 
-#if DEBUG_DRAW_USE_STD_MATH
+struct DebugStringStreams
+{
+    DebugString   * strings;     // Text, position and color of each string.
+    std::int64_t  * expiry;      // Expiration date in milliseconds.
 
-static inline float floatAbs(float x)       { return fabsf(x); }
-static inline float floatSin(float radians) { return sinf(radians); }
-static inline float floatCos(float radians) { return cosf(radians); }
-static inline float floatInvSqrt(float x)   { return (1.0f / sqrtf(x)); }
+    DebugStringStreams(QueueChunk * chunk, const int capacity)
+    {
+        std::uint8_t * cursor = reinterpret_cast<std::uint8_t *>(chunk) + QueueChunkHeaderSize;
+        strings = nextStream<DebugString>(cursor, capacity);
+        expiry  = nextStream<std::int64_t>(cursor, capacity);
+    }
 
-#else // !DEBUG_DRAW_USE_STD_MATH
+    static int chunkBytes(const int capacity)
+    {
+        return QueueChunkHeaderSize + streamBytes<DebugString>(capacity) + streamBytes<std::int64_t>(capacity);
+    }
 
-// ========================================================
-// Fast approximations of math functions used by Debug Draw
-// ========================================================
+    void construct(const int capacity) const
+    {
+        for (int i = 0; i < capacity; ++i)
+        {
+            ::new(&strings[i]) DebugString;
+        }
+    }
 
-union Float2UInt
-{
-    float asFloat;
-    std::uint32_t asUInt;
+    void destroy(const int capacity) const
+    {
+        for (int i = 0; i < capacity; ++i)
+        {
+            strings[i].~DebugString();
+        }
+    }
+
+    void move(const int from, const DebugStringStreams & dest, const int to) const
+    {
+        dest.strings[to] = strings[from];
+        dest.expiry[to]  = expiry[from];
+    }
 };
 
-static inline float floatRound(float x)
+//
+// Shape drawn as lines between shared vertexes. The geometry is 'vertexCount'
+// XYZ positions followed by 'indexCount' 16-bit vertex indexes, two per line,
+// in one of the context geometry arenas. A mesh without indexes is a line strip
+// through all of its vertexes in order, from dd::polyline().
+//
+struct DebugLineMesh
 {
-    // Probably slower than std::floor(), also depends of FPU settings,
-    // but we only need this for that special sin/cos() case anyways...
-    const int i = static_cast<int>(x);
-    return (x >= 0.0f) ? static_cast<float>(i) : static_cast<float>(i - 1);
-}
+    int           geometryOffset;
+    int           vertexCount;
+    int           indexCount;
+    std::uint32_t color;         // Packed RGBA8, shared by all lines.
+};
 
-static inline float floatAbs(float x)
+struct DebugMeshStreams
 {
-    // Mask-off the sign bit
+    DebugLineMesh * meshes;      // Geometry and color of each mesh.
+    std::int64_t  * expiry;      // Expiration date in milliseconds.
+
+    DebugMeshStreams(QueueChunk * chunk, const int capacity)
+    {
+        std::uint8_t * cursor = reinterpret_cast<std::uint8_t *>(chunk) + QueueChunkHeaderSize;
+        meshes = nextStream<DebugLineMesh>(cursor, capacity);
+        expiry = nextStream<std::int64_t>(cursor, capacity);
+    }
+
+    static int chunkBytes(const int capacity)
+    {
+        return QueueChunkHeaderSize + streamBytes<DebugLineMesh>(capacity) + streamBytes<std::int64_t>(capacity);
+    }
+
+    void construct(int) const { }
+    void destroy(int) const { }
+
+    void move(const int from, const DebugMeshStreams & dest, const int to) const
+    {
+        dest.meshes[to] = meshes[from];
+        dest.expiry[to] = expiry[from];
+    }
+};
+
+struct ShapeInstanceStreams
+{
+    ShapeInstance * instances;   // Transform and color, handed to the renderer as is.
+    std::int64_t  * expiry;      // Expiration date in milliseconds.
+
+    ShapeInstanceStreams(QueueChunk * chunk, const int capacity)
+    {
+        std::uint8_t * cursor = reinterpret_cast<std::uint8_t *>(chunk) + QueueChunkHeaderSize;
+        instances = nextStream<ShapeInstance>(cursor, capacity);
+        expiry    = nextStream<std::int64_t>(cursor, capacity);
+    }
+
+    static int chunkBytes(const int capacity)
+    {
+        return QueueChunkHeaderSize + streamBytes<ShapeInstance>(capacity) + streamBytes<std::int64_t>(capacity);
+    }
+
+    void construct(int) const { }
+    void destroy(int) const { }
+
+    void move(const int from, const ShapeInstanceStreams & dest, const int to) const
+    {
+        dest.instances[to] = instances[from];
+        dest.expiry[to]    = expiry[from];
+    }
+};
+
+struct DebugPointStreams
+{
+    float         * positions;   // XYZ, 3 floats per point.
+    std::uint32_t * colors;      // Packed RGBA8.
+    float         * sizes;       // Point size.
+    std::int64_t  * expiry;      // Expiration date in milliseconds.
+
+    DebugPointStreams(QueueChunk * chunk, const int capacity)
+    {
+        std::uint8_t * cursor = reinterpret_cast<std::uint8_t *>(chunk) + QueueChunkHeaderSize;
+        positions = nextStream<float>(cursor, capacity * 3);
+        colors    = nextStream<std::uint32_t>(cursor, capacity);
+        sizes     = nextStream<float>(cursor, capacity);
+        expiry    = nextStream<std::int64_t>(cursor, capacity);
+    }
+
+    static int chunkBytes(const int capacity)
+    {
+        return QueueChunkHeaderSize + streamBytes<float>(capacity * 3) + streamBytes<std::uint32_t>(capacity) +
+               streamBytes<float>(capacity) + streamBytes<std::int64_t>(capacity);
+    }
+
+    void construct(int) const { }
+    void destroy(int) const { }
+
+    void move(const int from, const DebugPointStreams & dest, const int to) const
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            dest.positions[to * 3 + c] = positions[from * 3 + c];
+        }
+        dest.colors[to] = colors[from];
+        dest.sizes[to]  = sizes[from];
+        dest.expiry[to] = expiry[from];
+    }
+};
+
+struct DebugLineStreams
+{
+    float         * positions;   // From XYZ then to XYZ, 6 floats per line.
+    std::uint32_t * colors;      // Packed RGBA8.
+    std::int64_t  * expiry;      // Expiration date in milliseconds.
+
+    DebugLineStreams(QueueChunk * chunk, const int capacity)
+    {
+        std::uint8_t * cursor = reinterpret_cast<std::uint8_t *>(chunk) + QueueChunkHeaderSize;
+        positions = nextStream<float>(cursor, capacity * 6);
+        colors    = nextStream<std::uint32_t>(cursor, capacity);
+        expiry    = nextStream<std::int64_t>(cursor, capacity);
+    }
+
+    static int chunkBytes(const int capacity)
+    {
+        return QueueChunkHeaderSize + streamBytes<float>(capacity * 6) +
+               streamBytes<std::uint32_t>(capacity) + streamBytes<std::int64_t>(capacity);
+    }
+
+    void construct(int) const { }
+    void destroy(int) const { }
+
+    void move(const int from, const DebugLineStreams & dest, const int to) const
+    {
+        for (int c = 0; c < 6; ++c)
+        {
+            dest.positions[to * 6 + c] = positions[from * 6 + c];
+        }
+        dest.colors[to] = colors[from];
+        dest.expiry[to] = expiry[from];
+    }
+};
+
+// Only the member matching the context vertex format is used
+// for points and lines. Text glyphs go in 'drawVerts', unless
+// the format is VertexFormatCustom.
+union VertexBuffer
+{
+    DrawVertex         drawVerts[DEBUG_DRAW_VERTEX_BUFFER_SIZE];
+    CompactVertex      compactVerts[DEBUG_DRAW_VERTEX_BUFFER_SIZE];
+    CompactPointVertex compactPointVerts[DEBUG_DRAW_VERTEX_BUFFER_SIZE];
+    HalfVertex         halfVerts[DEBUG_DRAW_VERTEX_BUFFER_SIZE];
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    CustomVertex       customVerts[DEBUG_DRAW_VERTEX_BUFFER_SIZE];
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+};
+
+// Batch of line meshes for the RenderInterface::drawIndexedLineList*() methods.
+// A batch never has more vertexes than 16-bit indexes can address.
+static const int MeshBatchMaxVerts   = (DEBUG_DRAW_VERTEX_BUFFER_SIZE < 65536) ? DEBUG_DRAW_VERTEX_BUFFER_SIZE : 65536;
+static const int MeshBatchMaxIndexes = MeshBatchMaxVerts * 4;
+
+struct MeshBuffer
+{
+    VertexBuffer       verts;
+    std::uint16_t      indexes[MeshBatchMaxIndexes];
+};
+
+// Upper limit of dd::ContextDesc::stagingBuffers.
+static const int MaxStagingBuffers = 8;
+
+// Room for one vertex of any format in the vertex buffers.
+static const int VertexBufferStride = static_cast<int>(sizeof(VertexBuffer) / DEBUG_DRAW_VERTEX_BUFFER_SIZE);
+
+// Batch of characters for RenderInterface::drawGlyphInstances().
+static const int GlyphBatchMaxGlyphs = DEBUG_DRAW_VERTEX_BUFFER_SIZE;
+
+struct InternalContext DD_EXPLICIT_CONTEXT_ONLY(: public OpaqueContextType)
+{
+    int                vertexBufferUsed;                            // Vertexes written to vertexDest so far.
+    int                vertexCapacity;                              // Size in vertexes of vertexDest.
+    void *             vertexDest;                                  // Batch being written, either a vertex buffer or renderer memory. Null if none.
+    bool               vertexDestAcquired;                          // vertexDest came from RenderInterface::acquireVertexSpace().
+    VertexFormat       vertexFormat;                                // Layout of point and line vertexes in the vertex buffers.
+    std::int64_t       currentTimeMillis;                           // Latest time value (in milliseconds) from dd::flush().
+    GlyphTextureHandle glyphTexHandle;                              // Our built-in glyph bitmap. If kept null, no text is rendered.
+    ShapeMeshHandle    shapeMeshes[ShapeMeshCount];                 // Unit meshes registered with the renderer. Shapes with a null one are drawn as line meshes.
+    RenderInterface *  renderInterface;                             // Ref to the external renderer. Can be null for a no-op debug draw.
+    Allocator *        allocator;                                   // Where all memory owned by the context comes from, including the context itself.
+    void *             vertexBuffers[MaxStagingBuffers];            // Vertex buffers we use to expand the lines/points before calling on RenderInterface. Allocated on first use.
+    int                vertexBufferSizes[MaxStagingBuffers];        // Size in vertexes of each vertex buffer. Only grows past DEBUG_DRAW_VERTEX_BUFFER_SIZE in single-shot mode.
+    bool               vertexBufferPending[MaxStagingBuffers];      // Handed to the renderer, which might still be reading it.
+    int                numVertexBuffers;                            // How many of vertexBuffers are in rotation.
+    int                currentVertexBuffer;                         // The one being written to.
+    bool               singleShot;                                  // Size each batch for all the vertexes left in its bucket, see dd::ContextDesc::singleShot.
+    int                vertexReserve;                               // Vertexes still expected in the bucket being drawn. Zero outside single-shot mode.
+    MeshBuffer *       meshBuffers[MaxStagingBuffers];              // Indexed line batches, rotated like vertexBuffers. Allocated on first use, freed if the renderer turns them down.
+    bool               meshBufferPending[MaxStagingBuffers];        // Handed to the renderer, which might still be reading it.
+    int                currentMeshBuffer;                           // The one being built.
+    int                meshVertsUsed;                               // Vertexes in the current mesh buffer.
+    int                meshIndexesUsed;                             // Indexes in the current mesh buffer.
+    bool               indexedLinesSupported;                       // Cleared when RenderInterface::drawIndexedLineList*() returns false.
+    bool               lineStripsSupported;                         // Cleared when RenderInterface::drawLineStrip*() returns false.
+    GlyphInstance *    glyphBuffers[MaxStagingBuffers];             // Glyph instance batches, rotated like vertexBuffers. Allocated on first use, freed if the renderer turns them down.
+    bool               glyphBufferPending[MaxStagingBuffers];       // Handed to the renderer, which might still be reading it.
+    int                currentGlyphBuffer;                          // The one being built.
+    int                glyphsUsed;                                  // Glyphs in the current glyph buffer.
+    bool               glyphInstancesSupported;                     // Cleared when RenderInterface::drawGlyphInstances() returns false.
+    bool               persistentRangesSupported;                   // Cleared when RenderInterface::drawPersistentRange() returns false.
+    std::uint32_t      nextRangeId;                                 // Id of the next persistent range handed to the renderer.
+    ChunkPool          stringsPool;                                 // Chunk storage for the strings queue.
+    ChunkPool          pointsPool;                                  // Chunk storage shared by both points queues.
+    ChunkPool          linesPool;                                   // Chunk storage shared by both lines queues.
+    ChunkPool          meshesPool;                                  // Chunk storage shared by both line meshes queues.
+    ChunkPool          instancesPool;                               // Chunk storage shared by all shape instance queues.
+    DebugQueue         debugStrings[DrawPriorityCount];             // Debug strings queues (2D screen-space strings + 3D projected labels), indexed by priority.
+    Arena              transientText;                               // Text of the strings in the transient lists of debugStrings.
+    Arena              timedText;                                   // Text of the timed strings in the debugStrings buckets.
+    Arena              scratchArena;                                // Compaction target for timedText and timedGeometry, swapped with them afterwards.
+    int                timedTextLive;                               // Bytes of timedText in use after its last compaction.
+    int                textArenaBytes;                              // Initial size of the text arenas, which dd::trim() never goes below.
+    DebugQueue         debugPoints[DrawPriorityCount][2];           // 3D debug points queues, indexed by priority and depthEnabled.
+    DebugQueue         debugLines[DrawPriorityCount][2];            // 3D debug lines queues, indexed by priority and depthEnabled.
+    DebugQueue         debugMeshes[DrawPriorityCount][2];           // 3D line meshes queues, indexed by priority and depthEnabled.
+    Arena              transientGeometry;                           // Geometry of the meshes in the transient lists of debugMeshes.
+    Arena              timedGeometry;                               // Geometry of the timed meshes in the debugMeshes buckets.
+    int                timedGeometryLive;                           // Bytes of timedGeometry in use after its last compaction.
+    DebugQueue         debugInstances[DrawPriorityCount][2][ShapeMeshCount]; // Shape instance queues, indexed by priority, depthEnabled and shape.
+    DrawPriority       drawPriority;                                // Priority of new draws, from dd::setDrawPriority().
+    bool               pointQuads;                                  // Expand points into quads for RenderInterface::drawPointQuads*().
+    bool               hasCamera;                                   // Set by dd::setCamera().
+    float              viewProjMatrix[16];                          // Camera from dd::setCamera().
+    int                viewportWidth;
+    int                viewportHeight;
+    float              lodPixelSize;                                // World size of a pixel at clip W = 1, zero without a usable camera.
+    float              lodTolerance;                                // From dd::setLodTolerance(), zero for full detail.
+    EvictionStats      evictionStats;                               // Counters returned by dd::getEvictionStats().
+    LodStats           lodStats;                                    // Counters returned by dd::getLodStats().
+
+    InternalContext(RenderInterface * renderer, Allocator & alloc)
+        : vertexBufferUsed(0)
+        , vertexCapacity(0)
+        , vertexDest(nullptr)
+        , vertexDestAcquired(false)
+        , vertexFormat(VertexFormatDefault)
+        , currentTimeMillis(0)
+        , glyphTexHandle(nullptr)
+        , shapeMeshes()
+        , renderInterface(renderer)
+        , allocator(&alloc)
+        , vertexBuffers()
+        , vertexBufferSizes()
+        , vertexBufferPending()
+        , numVertexBuffers(1)
+        , currentVertexBuffer(0)
+        , singleShot(false)
+        , vertexReserve(0)
+        , meshBuffers()
+        , meshBufferPending()
+        , currentMeshBuffer(0)
+        , meshVertsUsed(0)
+        , meshIndexesUsed(0)
+        , indexedLinesSupported(true)
+        , lineStripsSupported(true)
+        , glyphBuffers()
+        , glyphBufferPending()
+        , currentGlyphBuffer(0)
+        , glyphsUsed(0)
+        , glyphInstancesSupported(true)
+        , persistentRangesSupported(true)
+        , nextRangeId(1)
+        , stringsPool()
+        , pointsPool()
+        , linesPool()
+        , meshesPool()
+        , instancesPool()
+        , debugStrings()
+        , transientText()
+        , timedText()
+        , scratchArena()
+        , timedTextLive(0)
+        , textArenaBytes(0)
+        , debugPoints()
+        , debugLines()
+        , debugMeshes()
+        , transientGeometry()
+        , timedGeometry()
+        , timedGeometryLive(0)
+        , debugInstances()
+        , drawPriority(DrawPriorityNormal)
+        , pointQuads(false)
+        , hasCamera(false)
+        , viewProjMatrix()
+        , viewportWidth(0)
+        , viewportHeight(0)
+        , lodPixelSize(0.0f)
+        , lodTolerance(0.0f)
+        , evictionStats()
+        , lodStats()
+    { }
+};
+
+// ========================================================
+// Library context mode selection:
+// ========================================================
+
+#if (defined(DEBUG_DRAW_PER_THREAD_CONTEXT) && defined(DEBUG_DRAW_EXPLICIT_CONTEXT))
+    #error "DEBUG_DRAW_PER_THREAD_CONTEXT and DEBUG_DRAW_EXPLICIT_CONTEXT are mutually exclusive!"
+#endif // DEBUG_DRAW_PER_THREAD_CONTEXT && DEBUG_DRAW_EXPLICIT_CONTEXT
+
+#if defined(DEBUG_DRAW_EXPLICIT_CONTEXT)
+    //
+    // Explicit context passed as argument
+    //
+    #define DD_CONTEXT static_cast<InternalContext *>(ctx)
+#elif defined(DEBUG_DRAW_PER_THREAD_CONTEXT)
+    //
+    // Per-thread global context (MT safe)
+    //
+    #if defined(__GNUC__) || defined(__clang__) // GCC/Clang
+        #define DD_THREAD_LOCAL static __thread
+    #elif defined(_MSC_VER) // Visual Studio
+        #define DD_THREAD_LOCAL static __declspec(thread)
+    #else // Try C++11 thread_local
+        #if DEBUG_DRAW_CXX11_SUPPORTED
+            #define DD_THREAD_LOCAL static thread_local
+        #else // !DEBUG_DRAW_CXX11_SUPPORTED
+            #error "Unsupported compiler - unknown TLS model"
+        #endif // DEBUG_DRAW_CXX11_SUPPORTED
+    #endif // TLS model
+    DD_THREAD_LOCAL InternalContext * s_threadContext = nullptr;
+    #define DD_CONTEXT s_threadContext
+    #undef DD_THREAD_LOCAL
+#else // Debug Draw context selection
+    //
+    // Global static context (single threaded operation)
+    //
+    static InternalContext * s_globalContext = nullptr;
+    #define DD_CONTEXT s_globalContext
+#endif // Debug Draw context selection
+
+// ========================================================
+
+#if DEBUG_DRAW_USE_STD_MATH
+
+static inline float floatAbs(float x)       { return fabsf(x); }
+static inline float floatSin(float radians) { return sinf(radians); }
+static inline float floatCos(float radians) { return cosf(radians); }
+static inline float floatInvSqrt(float x)   { return (1.0f / sqrtf(x)); }
+
+#else // !DEBUG_DRAW_USE_STD_MATH
+
+// ========================================================
+// Fast approximations of math functions used by Debug Draw
+// ========================================================
+
+union Float2UInt
+{
+    float asFloat;
+    std::uint32_t asUInt;
+};
+
+static inline float floatRound(float x)
+{
+    // Probably slower than std::floor(), also depends of FPU settings,
+    // but we only need this for that special sin/cos() case anyways...
+    const int i = static_cast<int>(x);
+    return (x >= 0.0f) ? static_cast<float>(i) : static_cast<float>(i - 1);
+}
+
+static inline float floatAbs(float x)
+{
+    // Mask-off the sign bit
     Float2UInt i;
     i.asFloat = x;
     i.asUInt &= 0x7FFFFFFF;
@@ -2040,6 +3026,41 @@ static inline float floatCos(float radians)
 
 #endif // DEBUG_DRAW_USE_STD_MATH
 
+// ========================================================
+// Unit circle tables for the tessellated shapes
+// ========================================================
+
+// sin/cos of every multiple of StepDegrees in [0,360], inclusive, so that
+// the shapes only need multiply-adds per vertex. Entry 'NumSteps' repeats
+// entry 0 to close the rings. Built from floatSin/floatCos, so the shapes
+// produce exactly the same vertexes as computing the trig inline.
+template<int StepDegrees>
+struct SinCosTable
+{
+    static const int NumSteps = 360 / StepDegrees;
+
+    float sin[NumSteps + 1];
+    float cos[NumSteps + 1];
+
+    SinCosTable()
+    {
+        for (int i = 0; i <= NumSteps; ++i)
+        {
+            sin[i] = floatSin(degreesToRadians(i * StepDegrees));
+            cos[i] = floatCos(degreesToRadians(i * StepDegrees));
+        }
+    }
+};
+
+// Shared by all contexts and threads. Built on first use
+// (function local statics are initialized thread-safely).
+template<int StepDegrees>
+static const SinCosTable<StepDegrees> & sinCosTable()
+{
+    static const SinCosTable<StepDegrees> table;
+    return table;
+}
+
 // ========================================================
 // ddVec3 helpers:
 // ========================================================
@@ -2154,346 +3175,2984 @@ static inline float matTransformPointXYZW2(ddVec3_Out result, const float p[3],
 }
 
 // ========================================================
-// Misc local functions for draw queue management:
+// Batched math kernels:
 // ========================================================
 
-enum DrawMode
-{
-    DrawModePoints,
-    DrawModeLines,
-    DrawModeText
-};
+//
+// Both versions do the same float operations in the same order, so the SSE2
+// ones give the same results as the scalar ones, just a few points at a time.
+//
 
-static void flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DrawMode mode, const bool depthEnabled)
+// Transforms 'count' XYZ points by 'm', with W = 1, into 'count' XYZW results.
+static void transformPoints(float * const out, const float * const in, const int count, ddMat4x4_In m)
 {
-    if (DD_CONTEXT->vertexBufferUsed == 0)
+#if DEBUG_DRAW_USE_SIMD
+    // One column per register, so each point takes a single multiply-add chain.
+    const __m128 col0 = _mm_set_ps(m[3],  m[2],  m[1],  m[0]);
+    const __m128 col1 = _mm_set_ps(m[7],  m[6],  m[5],  m[4]);
+    const __m128 col2 = _mm_set_ps(m[11], m[10], m[9],  m[8]);
+    const __m128 col3 = _mm_set_ps(m[15], m[14], m[13], m[12]);
+
+    for (int i = 0; i < count; ++i)
     {
-        return;
+        const float * const p = &in[i * 3];
+        __m128 r = _mm_mul_ps(col0, _mm_set1_ps(p[X]));
+        r = _mm_add_ps(r, _mm_mul_ps(col1, _mm_set1_ps(p[Y])));
+        r = _mm_add_ps(r, _mm_mul_ps(col2, _mm_set1_ps(p[Z])));
+        r = _mm_add_ps(r, col3);
+        _mm_storeu_ps(&out[i * 4], r);
     }
-
-    switch (mode)
+#else // !DEBUG_DRAW_USE_SIMD
+    for (int i = 0; i < count; ++i)
     {
-    case DrawModePoints :
-        DD_CONTEXT->renderInterface->drawPointList(DD_CONTEXT->vertexBuffer,
-                                                   DD_CONTEXT->vertexBufferUsed,
-                                                   depthEnabled);
-        break;
-    case DrawModeLines :
-        DD_CONTEXT->renderInterface->drawLineList(DD_CONTEXT->vertexBuffer,
-                                                  DD_CONTEXT->vertexBufferUsed,
-                                                  depthEnabled);
-        break;
-    case DrawModeText :
-        DD_CONTEXT->renderInterface->drawGlyphList(DD_CONTEXT->vertexBuffer,
-                                                   DD_CONTEXT->vertexBufferUsed,
-                                                   DD_CONTEXT->glyphTexHandle);
-        break;
-    } // switch (mode)
-
-    DD_CONTEXT->vertexBufferUsed = 0;
+        const float * const p = &in[i * 3];
+        float * const r = &out[i * 4];
+        r[X] = (m[0] * p[X]) + (m[4] * p[Y]) + (m[8]  * p[Z]) + m[12];
+        r[Y] = (m[1] * p[X]) + (m[5] * p[Y]) + (m[9]  * p[Z]) + m[13];
+        r[Z] = (m[2] * p[X]) + (m[6] * p[Y]) + (m[10] * p[Z]) + m[14];
+        r[W] = (m[3] * p[X]) + (m[7] * p[Y]) + (m[11] * p[Z]) + m[15];
+    }
+#endif // DEBUG_DRAW_USE_SIMD
 }
 
-static void pushPointVert(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugPoint & point)
+// Writes the XYZ of 'count' points around a ring, from a unit circle table:
+//   out[i] = center + sinAxis * sines[i * step] + cosAxis * cosines[i * step]
+// The lengths of the axes give the radii, which can differ for ellipses.
+static void ringPoints(float * const out, ddVec3_In center, ddVec3_In sinAxis, ddVec3_In cosAxis,
+                       const float * const sines, const float * const cosines, const int step, const int count)
 {
-    // Make room for one more vert:
-    if ((DD_CONTEXT->vertexBufferUsed + 1) >= DEBUG_DRAW_VERTEX_BUFFER_SIZE)
+    int i = 0;
+
+#if DEBUG_DRAW_USE_SIMD
+    const __m128 cx = _mm_set1_ps(center[X]),  cy = _mm_set1_ps(center[Y]),  cz = _mm_set1_ps(center[Z]);
+    const __m128 sx = _mm_set1_ps(sinAxis[X]), sy = _mm_set1_ps(sinAxis[Y]), sz = _mm_set1_ps(sinAxis[Z]);
+    const __m128 kx = _mm_set1_ps(cosAxis[X]), ky = _mm_set1_ps(cosAxis[Y]), kz = _mm_set1_ps(cosAxis[Z]);
+
+    // Four points at a time, one coordinate per register.
+    for (; i + 4 <= count; i += 4)
+    {
+        const int j = i * step;
+        const __m128 s = _mm_set_ps(sines[j + 3 * step],   sines[j + 2 * step],   sines[j + step],   sines[j]);
+        const __m128 c = _mm_set_ps(cosines[j + 3 * step], cosines[j + 2 * step], cosines[j + step], cosines[j]);
+
+        const __m128 x = _mm_add_ps(_mm_add_ps(cx, _mm_mul_ps(sx, s)), _mm_mul_ps(kx, c));
+        const __m128 y = _mm_add_ps(_mm_add_ps(cy, _mm_mul_ps(sy, s)), _mm_mul_ps(ky, c));
+        const __m128 z = _mm_add_ps(_mm_add_ps(cz, _mm_mul_ps(sz, s)), _mm_mul_ps(kz, c));
+
+        // Transpose into x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3.
+        const __m128 xy01 = _mm_unpacklo_ps(x, y);                         // x0 y0 x1 y1
+        const __m128 xy23 = _mm_unpackhi_ps(x, y);                         // x2 y2 x3 y3
+        const __m128 z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)); // z0 z0 x1 x1
+        const __m128 y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)); // y1 y1 z1 z1
+        const __m128 z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)); // z2 z2 x3 x3
+        const __m128 y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)); // y3 y3 z3 z3
+
+        float * const dest = &out[i * 3];
+        _mm_storeu_ps(dest,     _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(dest + 4, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(dest + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif // DEBUG_DRAW_USE_SIMD
+
+    for (; i < count; ++i)
     {
-        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModePoints, point.depthEnabled);
+        const float s = sines[i * step];
+        const float c = cosines[i * step];
+        float * const dest = &out[i * 3];
+        dest[X] = (center[X] + (sinAxis[X] * s)) + (cosAxis[X] * c);
+        dest[Y] = (center[Y] + (sinAxis[Y] * s)) + (cosAxis[Y] * c);
+        dest[Z] = (center[Z] + (sinAxis[Z] * s)) + (cosAxis[Z] * c);
     }
+}
+
+// ========================================================
+// Vertex format helpers:
+// ========================================================
 
-    DrawVertex & v = DD_CONTEXT->vertexBuffer[DD_CONTEXT->vertexBufferUsed++];
-    v.point.x      = point.position[X];
-    v.point.y      = point.position[Y];
-    v.point.z      = point.position[Z];
-    v.point.r      = point.color[X];
-    v.point.g      = point.color[Y];
-    v.point.b      = point.color[Z];
-    v.point.size   = point.size;
+// Clamps to [0,1] first. NaN fails every comparison, so it maps to 0.
+static inline std::uint32_t packColorChannel(const float c)
+{
+    if (!(c > 0.0f)) { return 0;   }
+    if (c >= 1.0f)   { return 255; }
+    return static_cast<std::uint32_t>(c * 255.0f + 0.5f);
 }
 
-static void pushLineVert(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugLine & line)
+static inline float unpackColorChannel(const std::uint32_t color, const int shift)
 {
-    // Make room for two more verts:
-    if ((DD_CONTEXT->vertexBufferUsed + 2) >= DEBUG_DRAW_VERTEX_BUFFER_SIZE)
-    {
-        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, line.depthEnabled);
-    }
+    return static_cast<float>((color >> shift) & 0xFF) * (1.0f / 255.0f);
+}
 
-    DrawVertex & v0 = DD_CONTEXT->vertexBuffer[DD_CONTEXT->vertexBufferUsed++];
-    DrawVertex & v1 = DD_CONTEXT->vertexBuffer[DD_CONTEXT->vertexBufferUsed++];
+// RGB floats in the [0,1] range to RGBA8, red in the lowest byte and alpha = 255.
+static inline std::uint32_t packColor(ddVec3_In color)
+{
+    return packColorChannel(color[X])         |
+           (packColorChannel(color[Y]) << 8)  |
+           (packColorChannel(color[Z]) << 16) |
+           0xFF000000u;
+}
 
-    v0.line.x = line.posFrom[X];
-    v0.line.y = line.posFrom[Y];
-    v0.line.z = line.posFrom[Z];
-    v0.line.r = line.color[X];
-    v0.line.g = line.color[Y];
-    v0.line.b = line.color[Z];
+// Element 'index' of an array of floats with 'stride' bytes between elements.
+static inline const float * stridedElement(const float * const base, const int stride, const int index)
+{
+    return reinterpret_cast<const float *>(reinterpret_cast<const std::uint8_t *>(base) +
+                                           static_cast<std::ptrdiff_t>(index) * stride);
+}
 
-    v1.line.x = line.posTo[X];
-    v1.line.y = line.posTo[Y];
-    v1.line.z = line.posTo[Z];
-    v1.line.r = line.color[X];
-    v1.line.g = line.color[Y];
-    v1.line.b = line.color[Z];
+// Packed color of element 'index' of an array of RGB floats. With a zero stride all share the first.
+static inline std::uint32_t packStridedColor(const float * const colors, const int stride, const int index)
+{
+    const float * const rgb = stridedElement(colors, stride, index);
+    return packColorChannel(rgb[0])         |
+           (packColorChannel(rgb[1]) << 8)  |
+           (packColorChannel(rgb[2]) << 16) |
+           0xFF000000u;
 }
 
-static void pushGlyphVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DrawVertex verts[4])
+// Adds one to the truncated 'half' if the 'dropped' bits are past 'halfway',
+// or right on it and the half is odd (round to nearest, ties to even).
+static inline std::uint32_t roundHalfToEven(const std::uint32_t half, const std::uint32_t dropped,
+                                            const std::uint32_t halfway)
 {
-    static const int indexes[6] = { 0, 1, 2, 2, 1, 3 };
+    return half + ((dropped > halfway || (dropped == halfway && (half & 1) != 0)) ? 1 : 0);
+}
 
-    // Make room for one more glyph (2 tris):
-    if ((DD_CONTEXT->vertexBufferUsed + 6) >= DEBUG_DRAW_VERTEX_BUFFER_SIZE)
+// IEEE 754 single to half precision, rounding to nearest even.
+// Values too large for a half become infinity, NaNs are preserved.
+static inline std::uint16_t floatToHalf(const float f)
+{
+    union { float asFloat; std::uint32_t asUInt; } bits;
+    bits.asFloat = f;
+
+    const std::uint32_t sign     = (bits.asUInt >> 16) & 0x8000;
+    const std::uint32_t exponent = (bits.asUInt >> 23) & 0xFF;
+    std::uint32_t       mantissa = bits.asUInt & 0x7FFFFF;
+
+    if (exponent == 0xFF) // Inf or NaN
     {
-        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeText, false);
+        return static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
     }
 
-    for (int i = 0; i < 6; ++i)
+    const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 31) // Overflow
     {
-        DD_CONTEXT->vertexBuffer[DD_CONTEXT->vertexBufferUsed++].glyph = verts[indexes[i]].glyph;
+        return static_cast<std::uint16_t>(sign | 0x7C00);
     }
-}
-
-static void pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) float x, float y,
-                             const char * text, ddVec3_In color, const float scaling)
-{
-    // Invariants for all characters:
-    const float initialX    = x;
-    const float scaleU      = static_cast<float>(getFontCharSet().bitmapWidth);
-    const float scaleV      = static_cast<float>(getFontCharSet().bitmapHeight);
-    const float fixedWidth  = static_cast<float>(getFontCharSet().charWidth);
-    const float fixedHeight = static_cast<float>(getFontCharSet().charHeight);
-    const float tabW        = fixedWidth  * 4.0f * scaling; // TAB = 4 spaces.
-    const float chrW        = fixedWidth  * scaling;
-    const float chrH        = fixedHeight * scaling;
-
-    for (; *text != '\0'; ++text)
+    if (halfExponent <= 0) // Subnormal half or zero
     {
-        const int charVal = *text;
-        if (charVal >= FontCharSet::MaxChars)
-        {
-            continue;
-        }
-        if (charVal == ' ')
-        {
-            x += chrW;
-            continue;
-        }
-        if (charVal == '\t')
-        {
-            x += tabW;
-            continue;
-        }
-        if (charVal == '\n')
+        if (halfExponent < -10)
         {
-            y += chrH;
-            x  = initialX;
-            continue;
+            return static_cast<std::uint16_t>(sign);
         }
-
-        const FontChar fontChar = getFontCharSet().chars[charVal];
-        const float u0 = (fontChar.x + 0.5f) / scaleU;
-        const float v0 = (fontChar.y + 0.5f) / scaleV;
-        const float u1 = u0 + (fixedWidth  / scaleU);
-        const float v1 = v0 + (fixedHeight / scaleV);
-
-        DrawVertex verts[4];
-        verts[0].glyph.x = x;
-        verts[0].glyph.y = y;
-        verts[0].glyph.u = u0;
-        verts[0].glyph.v = v0;
-        verts[0].glyph.r = color[X];
-        verts[0].glyph.g = color[Y];
-        verts[0].glyph.b = color[Z];
-        verts[1].glyph.x = x;
-        verts[1].glyph.y = y + chrH;
-        verts[1].glyph.u = u0;
-        verts[1].glyph.v = v1;
-        verts[1].glyph.r = color[X];
-        verts[1].glyph.g = color[Y];
-        verts[1].glyph.b = color[Z];
-        verts[2].glyph.x = x + chrW;
-        verts[2].glyph.y = y;
-        verts[2].glyph.u = u1;
-        verts[2].glyph.v = v0;
-        verts[2].glyph.r = color[X];
-        verts[2].glyph.g = color[Y];
-        verts[2].glyph.b = color[Z];
-        verts[3].glyph.x = x + chrW;
-        verts[3].glyph.y = y + chrH;
-        verts[3].glyph.u = u1;
-        verts[3].glyph.v = v1;
-        verts[3].glyph.r = color[X];
-        verts[3].glyph.g = color[Y];
-        verts[3].glyph.b = color[Z];
-
-        pushGlyphVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) verts);
-        x += chrW;
+        mantissa |= 0x800000;
+        const int shift = 14 - halfExponent;
+        const std::uint32_t half = roundHalfToEven(mantissa >> shift, mantissa & ((1u << shift) - 1),
+                                                   1u << (shift - 1));
+        return static_cast<std::uint16_t>(sign | half);
     }
+
+    // Rounding may carry into the exponent, which is still the correct result.
+    const std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    return static_cast<std::uint16_t>(sign | roundHalfToEven(half, mantissa & 0x1FFF, 0x1000));
 }
 
-static float calcTextWidth(const char * text, const float scaling)
-{
-    const float fixedWidth = static_cast<float>(getFontCharSet().charWidth);
-    const float tabW = fixedWidth * 4.0f * scaling; // TAB = 4 spaces.
-    const float chrW = fixedWidth * scaling;
+//
+// Writers for each of the point and line vertex formats.
+// 'pos' is the queued XYZ position (XYZ pair for lines).
+//
+
+static inline void writePointVertex(DrawVertex & v, const float * pos, const std::uint32_t color, const float size)
+{
+    v.point.x    = pos[0];
+    v.point.y    = pos[1];
+    v.point.z    = pos[2];
+    v.point.r    = unpackColorChannel(color, 0);
+    v.point.g    = unpackColorChannel(color, 8);
+    v.point.b    = unpackColorChannel(color, 16);
+    v.point.size = size;
+}
+
+static inline void writePointVertex(CompactPointVertex & v, const float * pos, const std::uint32_t color, const float size)
+{
+    v.x     = pos[0];
+    v.y     = pos[1];
+    v.z     = pos[2];
+    v.color = color;
+    v.size  = size;
+}
+
+static inline void writePointVertex(HalfVertex & v, const float * pos, const std::uint32_t color, const float size)
+{
+    v.x     = floatToHalf(pos[0]);
+    v.y     = floatToHalf(pos[1]);
+    v.z     = floatToHalf(pos[2]);
+    v.size  = floatToHalf(size);
+    v.color = color;
+}
+
+static inline void writeLineVertex(DrawVertex & v, const float * pos, const std::uint32_t color)
+{
+    v.line.x = pos[0];
+    v.line.y = pos[1];
+    v.line.z = pos[2];
+    v.line.r = unpackColorChannel(color, 0);
+    v.line.g = unpackColorChannel(color, 8);
+    v.line.b = unpackColorChannel(color, 16);
+}
+
+static inline void writeLineVertex(CompactVertex & v, const float * pos, const std::uint32_t color)
+{
+    v.x     = pos[0];
+    v.y     = pos[1];
+    v.z     = pos[2];
+    v.color = color;
+}
+
+static inline void writeLineVertex(HalfVertex & v, const float * pos, const std::uint32_t color)
+{
+    v.x     = floatToHalf(pos[0]);
+    v.y     = floatToHalf(pos[1]);
+    v.z     = floatToHalf(pos[2]);
+    v.size  = 0;
+    v.color = color;
+}
+
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+static inline void writePointVertex(CustomVertex & v, const float * pos, const std::uint32_t color, const float size)
+{
+    VertexWriter<CustomVertex>::writePoint(v, pos, color, size);
+}
+
+static inline void writeLineVertex(CustomVertex & v, const float * pos, const std::uint32_t color)
+{
+    VertexWriter<CustomVertex>::writeLine(v, pos, color);
+}
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+template<typename V>
+static inline void writeLineVertexes(V * v, const float * pos, const std::uint32_t color)
+{
+    writeLineVertex(v[0], pos,     color);
+    writeLineVertex(v[1], pos + 3, color);
+}
+
+// ========================================================
+// DebugQueue helpers:
+// ========================================================
+
+// Free list of the chunks with room for 'capacity' elements.
+static inline QueueChunk *& poolFreeList(ChunkPool & pool, const int capacity)
+{
+    return (capacity == pool.chunkCapacity) ? pool.freeList : pool.bucketFreeList;
+}
+
+// S is one of the *Streams chunk views.
+template<typename S>
+static QueueChunk * poolAllocChunk(ChunkPool & pool, const int capacity)
+{
+    QueueChunk *& freeList = poolFreeList(pool, capacity);
+    QueueChunk * chunk = freeList;
+    if (chunk != nullptr)
+    {
+        freeList = chunk->next;
+    }
+    else
+    {
+        void * buffer = pool.allocator->allocate(S::chunkBytes(capacity), 16);
+        if (buffer == nullptr)
+        {
+            return nullptr;
+        }
+
+        chunk = static_cast<QueueChunk *>(buffer);
+        chunk->capacity = capacity;
+        S(chunk, capacity).construct(capacity);
+        if (capacity == pool.chunkCapacity)
+        {
+            ++pool.numChunks;
+        }
+    }
+
+    chunk->next  = nullptr;
+    chunk->count = 0;
+    return chunk;
+}
+
+// Moves the chunks from 'head' to 'tail', all of the same size, back to the free list.
+static inline void poolFreeChunks(ChunkPool & pool, QueueChunk * const head, QueueChunk * const tail)
+{
+    QueueChunk *& freeList = poolFreeList(pool, head->capacity);
+    tail->next = freeList;
+    freeList   = head;
+}
+
+template<typename S>
+static void poolDeallocChunk(ChunkPool & pool, QueueChunk * const chunk)
+{
+    S(chunk, chunk->capacity).destroy(chunk->capacity);
+    pool.allocator->deallocate(chunk, S::chunkBytes(chunk->capacity));
+}
+
+template<typename S>
+static bool poolInit(ChunkPool & pool, Allocator & allocator, const QueueDesc & desc)
+{
+    pool.allocator      = &allocator;
+    pool.freeList       = nullptr;
+    pool.bucketFreeList = nullptr;
+    pool.numChunks      = 0;
+    pool.minChunks      = 0;
+    pool.count          = 0;
+    pool.chunkCapacity  = (desc.chunkCapacity > 0) ? desc.chunkCapacity : DEBUG_DRAW_QUEUE_CHUNK_SIZE;
+    pool.maxCount       = (desc.maxCapacity   > 0) ? desc.maxCapacity : 0;
+
+    // A 16th of the transient chunks, but no less than 16 elements unless those are smaller.
+    pool.bucketChunkCapacity = pool.chunkCapacity / 16;
+    if (pool.bucketChunkCapacity < 16)
+    {
+        pool.bucketChunkCapacity = (pool.chunkCapacity < 16) ? pool.chunkCapacity : 16;
+    }
+
+    // Preallocate the initial chunks straight into the free list:
+    int initialChunks = (desc.initialCapacity + pool.chunkCapacity - 1) / pool.chunkCapacity;
+    const int maxChunks = (pool.maxCount + pool.chunkCapacity - 1) / pool.chunkCapacity;
+    if (pool.maxCount != 0 && initialChunks > maxChunks)
+    {
+        initialChunks = maxChunks;
+    }
+
+    for (int i = 0; i < initialChunks; ++i)
+    {
+        QueueChunk * chunk = poolAllocChunk<S>(pool, pool.chunkCapacity);
+        if (chunk == nullptr)
+        {
+            return false;
+        }
+        chunk->next   = pool.freeList;
+        pool.freeList = chunk;
+    }
+    pool.minChunks = initialChunks;
+    return true;
+}
+
+// Frees chunks from the free lists until the pool is back to its initial size.
+template<typename S>
+static void poolTrim(ChunkPool & pool)
+{
+    while (pool.freeList != nullptr && pool.numChunks > pool.minChunks)
+    {
+        QueueChunk * chunk = pool.freeList;
+        pool.freeList = chunk->next;
+        poolDeallocChunk<S>(pool, chunk);
+        --pool.numChunks;
+    }
+    while (pool.bucketFreeList != nullptr)
+    {
+        QueueChunk * chunk = pool.bucketFreeList;
+        pool.bucketFreeList = chunk->next;
+        poolDeallocChunk<S>(pool, chunk);
+    }
+}
+
+// Frees all chunks in the free lists. Queues using
+// the pool must have been reset or released first.
+template<typename S>
+static void poolRelease(ChunkPool & pool)
+{
+    QueueChunk * const lists[2] = { pool.freeList, pool.bucketFreeList };
+    for (int l = 0; l < 2; ++l)
+    {
+        QueueChunk * chunk = lists[l];
+        while (chunk != nullptr)
+        {
+            QueueChunk * const next = chunk->next;
+            poolDeallocChunk<S>(pool, chunk);
+            chunk = next;
+        }
+    }
+    pool.freeList       = nullptr;
+    pool.bucketFreeList = nullptr;
+    pool.numChunks      = 0;
+}
+
+static void queueInit(DebugQueue & queue, ChunkPool & pool, const int bucketMillis)
+{
+    queue.pool         = &pool;
+    queue.transient    = QueueBucket();
+    queue.buckets      = nullptr;
+    queue.bucketMillis = (bucketMillis > 0) ? bucketMillis : DEBUG_DRAW_EXPIRY_BUCKET_MILLIS;
+    queue.numBuckets   = 0;
+    queue.maxBuckets   = 0;
+    queue.lastBucket   = 0;
+    queue.count        = 0;
+}
+
+// Finds the bucket for the given expiry date, inserting a new empty one
+// in sorted position if needed. Returns null if out of memory.
+static QueueBucket * queueFindBucket(DebugQueue & queue, const std::int64_t expiry)
+{
+    std::int64_t key = expiry / queue.bucketMillis;
+    if (expiry < 0 && (key * queue.bucketMillis) != expiry)
+    {
+        --key; // Round towards negative infinity.
+    }
+
+    // Fast path: same bucket as the previous push.
+    if (queue.lastBucket < queue.numBuckets && queue.buckets[queue.lastBucket].key == key)
+    {
+        return &queue.buckets[queue.lastBucket];
+    }
+
+    // Binary search for the first bucket with a key not less than ours:
+    int lo = 0;
+    int hi = queue.numBuckets;
+    while (lo < hi)
+    {
+        const int mid = (lo + hi) / 2;
+        if (queue.buckets[mid].key < key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if (lo < queue.numBuckets && queue.buckets[lo].key == key)
+    {
+        queue.lastBucket = lo;
+        return &queue.buckets[lo];
+    }
+
+    if (queue.numBuckets == queue.maxBuckets)
+    {
+        Allocator & allocator = *queue.pool->allocator;
+        const int newMax = (queue.maxBuckets > 0) ? (queue.maxBuckets * 2) : 16;
+        void * newBuckets = (queue.buckets != nullptr) ?
+            allocator.reallocate(queue.buckets, sizeof(QueueBucket) * queue.maxBuckets,
+                                 sizeof(QueueBucket) * newMax, alignof(QueueBucket)) :
+            allocator.allocate(sizeof(QueueBucket) * newMax, alignof(QueueBucket));
+        if (newBuckets == nullptr)
+        {
+            return nullptr;
+        }
+
+        queue.buckets    = static_cast<QueueBucket *>(newBuckets);
+        queue.maxBuckets = newMax;
+    }
+
+    for (int i = queue.numBuckets; i > lo; --i)
+    {
+        queue.buckets[i] = queue.buckets[i - 1];
+    }
+    ++queue.numBuckets;
+
+    QueueBucket & bucket = queue.buckets[lo];
+    bucket.key       = key;
+    bucket.minExpiry = expiry;
+    bucket.maxExpiry = expiry;
+    bucket.head         = nullptr;
+    bucket.tail         = nullptr;
+    bucket.count        = 0;
+    bucket.version      = 0;
+    bucket.rangeId      = 0;
+    bucket.rangeVersion = 0;
+
+    queue.lastBucket = lo;
+    return &bucket;
+}
+
+// Appends an element expiring at the given date and returns the chunk
+// holding it. The new element is at index (chunk->count - 1) and has its
+// expiry already set. Returns null if the queues sharing the pool hold as many
+// elements as they can, or if a new chunk can't be allocated.
+// Transient elements (zero duration) skip the bucket lookup.
+template<typename S>
+static QueueChunk * queuePush(DebugQueue & queue, const std::int64_t expiry, const bool transient)
+{
+    ChunkPool & pool = *queue.pool;
+    if (pool.maxCount != 0 && pool.count >= pool.maxCount)
+    {
+        return nullptr;
+    }
+
+    QueueBucket * bucket = transient ? &queue.transient : queueFindBucket(queue, expiry);
+    if (bucket == nullptr)
+    {
+        return nullptr;
+    }
+
+    QueueChunk * chunk = bucket->tail;
+    if (chunk == nullptr || chunk->count == chunk->capacity)
+    {
+        QueueChunk * newChunk = poolAllocChunk<S>(pool, transient ? pool.chunkCapacity : pool.bucketChunkCapacity);
+        if (newChunk == nullptr)
+        {
+            return nullptr; // Might leave an empty bucket behind, dropped on the next flush.
+        }
+
+        if (chunk != nullptr)
+        {
+            chunk->next = newChunk;
+        }
+        else
+        {
+            bucket->head = newChunk;
+        }
+        bucket->tail = chunk = newChunk;
+    }
+
+    if (bucket->count == 0)
+    {
+        bucket->minExpiry = expiry;
+        bucket->maxExpiry = expiry;
+    }
+    else
+    {
+        if (expiry < bucket->minExpiry) { bucket->minExpiry = expiry; }
+        if (expiry > bucket->maxExpiry) { bucket->maxExpiry = expiry; }
+    }
+
+    S(chunk, chunk->capacity).expiry[chunk->count] = expiry;
+    ++bucket->version;
+    ++bucket->count;
+    ++queue.count;
+    ++pool.count;
+    ++chunk->count;
+    return chunk;
+}
+
+// Moves the chunks of a bucket back to the free list.
+static void queueRecycleBucket(DebugQueue & queue, QueueBucket & bucket)
+{
+    if (bucket.tail != nullptr)
+    {
+        poolFreeChunks(*queue.pool, bucket.head, bucket.tail);
+    }
+    queue.count       -= bucket.count;
+    queue.pool->count -= bucket.count;
+
+    bucket.head  = nullptr;
+    bucket.tail  = nullptr;
+    bucket.count = 0;
+}
+
+// Chunk iteration over the transient list then all buckets, in expiry order:
+//   int b;
+//   for (QueueChunk * c = queueFirstChunk(q, b); c != nullptr; c = queueNextChunk(q, c, b)) { }
+static QueueChunk * queueNextChunk(const DebugQueue & queue, const QueueChunk * chunk, int & bucket)
+{
+    if (chunk != nullptr && chunk->next != nullptr)
+    {
+        return chunk->next;
+    }
+    while (++bucket < queue.numBuckets)
+    {
+        if (queue.buckets[bucket].head != nullptr)
+        {
+            return queue.buckets[bucket].head;
+        }
+    }
+    return nullptr;
+}
+
+static QueueChunk * queueFirstChunk(const DebugQueue & queue, int & bucket)
+{
+    bucket = -1; // The transient list.
+    if (queue.transient.head != nullptr)
+    {
+        return queue.transient.head;
+    }
+    return queueNextChunk(queue, nullptr, bucket);
+}
+
+// Frees the buckets array if no bucket is in use.
+static void queueTrim(DebugQueue & queue)
+{
+    if (queue.numBuckets == 0 && queue.buckets != nullptr)
+    {
+        queue.pool->allocator->deallocate(queue.buckets, sizeof(QueueBucket) * queue.maxBuckets);
+        queue.buckets    = nullptr;
+        queue.maxBuckets = 0;
+        queue.lastBucket = 0;
+    }
+}
+
+// Moves all chunks back to the free list.
+static void queueReset(DebugQueue & queue)
+{
+    queueRecycleBucket(queue, queue.transient);
+    for (int b = 0; b < queue.numBuckets; ++b)
+    {
+        queueRecycleBucket(queue, queue.buckets[b]);
+    }
+    queue.numBuckets = 0;
+    queue.lastBucket = 0;
+    queue.count      = 0;
+}
+
+// Gives all chunks back to the pool and frees the buckets array.
+static void queueRelease(DebugQueue & queue)
+{
+    queueReset(queue);
+    queueTrim(queue);
+}
+
+// The chunk list with the earliest expiry dates, null if the queue is empty.
+static QueueBucket * queueFirstToExpire(DebugQueue & queue)
+{
+    if (queue.transient.count != 0)
+    {
+        return &queue.transient;
+    }
+    for (int b = 0; b < queue.numBuckets; ++b)
+    {
+        if (queue.buckets[b].count != 0)
+        {
+            return &queue.buckets[b];
+        }
+    }
+    return nullptr;
+}
+
+// Drops the last element of a bucket to make room for one more. The bucket's
+// dates are left as they are, a range that still covers what's left, and the
+// expiry pass recycles the bucket if it turns out to be empty. A tail chunk
+// left empty is unlinked, which is the only time the chunk list is walked.
+static void queueEvictElement(DebugQueue & queue, QueueBucket & bucket)
+{
+    --bucket.count;
+    --queue.count;
+    --queue.pool->count;
+    ++bucket.version;
+
+    QueueChunk * const tail = bucket.tail;
+    if (--tail->count != 0)
+    {
+        return;
+    }
+
+    if (bucket.head == tail)
+    {
+        // Same state as a bucket that failed its first push,
+        // which the expiry pass drops without compacting.
+        poolFreeChunks(*queue.pool, tail, tail);
+        bucket.head      = nullptr;
+        bucket.tail      = nullptr;
+        bucket.minExpiry = bucket.maxExpiry;
+        return;
+    }
+
+    QueueChunk * prev = bucket.head;
+    while (prev->next != tail)
+    {
+        prev = prev->next;
+    }
+    prev->next  = nullptr;
+    bucket.tail = prev;
+    poolFreeChunks(*queue.pool, tail, tail);
+}
+
+// ========================================================
+// Arena helpers:
+// ========================================================
+
+// Makes room for 'bytes' more bytes, doubling the capacity until they fit.
+static bool arenaReserve(Arena & arena, Allocator & allocator, const int bytes)
+{
+    if (arena.used + bytes <= arena.capacity)
+    {
+        return true;
+    }
+
+    int newCapacity = (arena.capacity > 0) ? arena.capacity * 2 : bytes;
+    while (newCapacity < arena.used + bytes)
+    {
+        newCapacity *= 2;
+    }
+
+    void * newData = (arena.data != nullptr) ?
+        allocator.reallocate(arena.data, arena.capacity, newCapacity, 4) :
+        allocator.allocate(newCapacity, 4);
+    if (newData == nullptr)
+    {
+        return false;
+    }
+
+    arena.data     = static_cast<char *>(newData);
+    arena.capacity = newCapacity;
+    return true;
+}
+
+// Appends 'length' chars of 'str' plus a null terminator. The arena
+// must have room for them already. Returns the offset of the copy.
+static int arenaAppend(Arena & arena, const char * str, const int length)
+{
+    const int offset = arena.used;
+    char * dest = arena.data + offset;
+    for (int i = 0; i < length; ++i)
+    {
+        dest[i] = str[i];
+    }
+    dest[length] = '\0';
+    arena.used += length + 1;
+    return offset;
+}
+
+// Bytes an arenaAlloc() of 'bytes' can take, counting the alignment padding.
+static inline int arenaAllocBytes(const int bytes)
+{
+    return bytes + 3;
+}
+
+// Returns the offset of 'bytes' uninitialized bytes, 4-byte aligned.
+// The arena must have room for arenaAllocBytes(bytes) already.
+static int arenaAlloc(Arena & arena, const int bytes)
+{
+    const int offset = (arena.used + 3) & ~3;
+    arena.used = offset + bytes;
+    return offset;
+}
+
+static void arenaRelease(Arena & arena, Allocator & allocator)
+{
+    if (arena.data != nullptr)
+    {
+        allocator.deallocate(arena.data, arena.capacity);
+    }
+    arena.data     = nullptr;
+    arena.used     = 0;
+    arena.capacity = 0;
+}
+
+// Shrinks the arena back to 'bytes' if what is in use fits in there.
+static void arenaTrim(Arena & arena, Allocator & allocator, const int bytes)
+{
+    if (arena.capacity <= bytes || arena.used > bytes)
+    {
+        return;
+    }
+
+    if (bytes <= 0)
+    {
+        arenaRelease(arena, allocator);
+        return;
+    }
+
+    void * newData = allocator.reallocate(arena.data, arena.capacity, bytes, 4);
+    if (newData != nullptr)
+    {
+        arena.data     = static_cast<char *>(newData);
+        arena.capacity = bytes;
+    }
+}
+
+// ========================================================
+// Misc local functions for draw queue management:
+// ========================================================
+
+// Called after the current vertex buffer was passed to the renderer.
+// With more than one buffer, the next one in rotation becomes current.
+static void retireVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (DD_CONTEXT->numVertexBuffers > 1)
+    {
+        DD_CONTEXT->vertexBufferPending[DD_CONTEXT->currentVertexBuffer] = true;
+        DD_CONTEXT->currentVertexBuffer = (DD_CONTEXT->currentVertexBuffer + 1) % DD_CONTEXT->numVertexBuffers;
+    }
+}
+
+static void flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DrawMode mode, const bool depthEnabled)
+{
+    if (DD_CONTEXT->vertexDest == nullptr)
+    {
+        return;
+    }
+
+    RenderInterface * const renderer = DD_CONTEXT->renderInterface;
+    const void * const verts = DD_CONTEXT->vertexDest;
+    const int count = DD_CONTEXT->vertexBufferUsed;
+
+    DD_CONTEXT->vertexDest       = nullptr;
+    DD_CONTEXT->vertexBufferUsed = 0;
+    DD_CONTEXT->vertexReserve    = (DD_CONTEXT->vertexReserve > count) ? (DD_CONTEXT->vertexReserve - count) : 0;
+
+    if (DD_CONTEXT->vertexDestAcquired)
+    {
+        renderer->commitVertexSpace(mode, depthEnabled, count);
+        return;
+    }
+
+    const DrawVertex         * const drawVerts         = static_cast<const DrawVertex *>(verts);
+    const CompactVertex      * const compactVerts      = static_cast<const CompactVertex *>(verts);
+    const CompactPointVertex * const compactPointVerts = static_cast<const CompactPointVertex *>(verts);
+    const HalfVertex         * const halfVerts         = static_cast<const HalfVertex *>(verts);
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    const CustomVertex       * const customVerts       = static_cast<const CustomVertex *>(verts);
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    switch (mode)
+    {
+    case DrawModePoints :
+        switch (DD_CONTEXT->vertexFormat)
+        {
+        case VertexFormatCompact     : renderer->drawPointListCompact(compactPointVerts, count, depthEnabled); break;
+        case VertexFormatCompactHalf : renderer->drawPointListHalf(halfVerts, count, depthEnabled);            break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        case VertexFormatCustom      : renderer->drawPointListCustom(customVerts, count, depthEnabled);        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        default                      : renderer->drawPointList(drawVerts, count, depthEnabled);                break;
+        } // switch (DD_CONTEXT->vertexFormat)
+        break;
+    case DrawModeLines :
+        switch (DD_CONTEXT->vertexFormat)
+        {
+        case VertexFormatCompact     : renderer->drawLineListCompact(compactVerts, count, depthEnabled); break;
+        case VertexFormatCompactHalf : renderer->drawLineListHalf(halfVerts, count, depthEnabled);       break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        case VertexFormatCustom      : renderer->drawLineListCustom(customVerts, count, depthEnabled);   break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        default                      : renderer->drawLineList(drawVerts, count, depthEnabled);           break;
+        } // switch (DD_CONTEXT->vertexFormat)
+        break;
+    case DrawModeText :
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        if (DD_CONTEXT->vertexFormat == VertexFormatCustom)
+        {
+            renderer->drawGlyphListCustom(customVerts, count, DD_CONTEXT->glyphTexHandle);
+            break;
+        }
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        renderer->drawGlyphList(drawVerts, count, DD_CONTEXT->glyphTexHandle);
+        break;
+    case DrawModePointQuads :
+        switch (DD_CONTEXT->vertexFormat)
+        {
+        case VertexFormatCompact     : renderer->drawPointQuadsCompact(compactVerts, count, depthEnabled); break;
+        case VertexFormatCompactHalf : renderer->drawPointQuadsHalf(halfVerts, count, depthEnabled);       break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        case VertexFormatCustom      : renderer->drawPointQuadsCustom(customVerts, count, depthEnabled);   break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        default                      : renderer->drawPointQuads(drawVerts, count, depthEnabled);           break;
+        } // switch (DD_CONTEXT->vertexFormat)
+        break;
+    } // switch (mode)
+
+    retireVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+}
+
+// Our current vertex buffer, with room for at least 'minCount' vertexes of any format.
+// Allocated on first use, renderers that take the vertexes from the acquired space might
+// never need it. If the renderer might still be reading it from an earlier draw call,
+// waits for it first.
+static void * getVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) int minCount)
+{
+    const int current = DD_CONTEXT->currentVertexBuffer;
+    void *& vb = DD_CONTEXT->vertexBuffers[current];
+
+    if (vb != nullptr && DD_CONTEXT->vertexBufferPending[current])
+    {
+        DD_CONTEXT->renderInterface->waitBufferConsumed(vb);
+        DD_CONTEXT->vertexBufferPending[current] = false;
+    }
+
+    if (vb != nullptr && DD_CONTEXT->vertexBufferSizes[current] < minCount)
+    {
+        DD_CONTEXT->allocator->deallocate(vb, DD_CONTEXT->vertexBufferSizes[current] * VertexBufferStride);
+        vb = nullptr;
+    }
+
+    if (vb == nullptr)
+    {
+        if (minCount < DEBUG_DRAW_VERTEX_BUFFER_SIZE)
+        {
+            minCount = DEBUG_DRAW_VERTEX_BUFFER_SIZE;
+        }
+
+        vb = DD_CONTEXT->allocator->allocate(minCount * VertexBufferStride, alignof(VertexBuffer));
+        DD_CONTEXT->vertexBufferSizes[current] = (vb != nullptr) ? minCount : 0;
+        if (vb == nullptr)
+        {
+            DEBUG_DRAW_OVERFLOWED("Failed to allocate the vertex buffer! Dropping debug draws.");
+        }
+    }
+    return vb;
+}
+
+// Makes sure a batch for the given primitive is open with room for at least one
+// more primitive of 'vertsPerPrim' vertexes, flushing the current one if full.
+// The batch goes into renderer memory if acquireVertexSpace() provides it, else
+// into our own vertex buffer. Returns how many more primitives fit in the batch,
+// zero if we are out of memory.
+static int beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DrawMode mode,
+                           const bool depthEnabled, const int vertsPerPrim)
+{
+    if ((DD_CONTEXT->vertexBufferUsed + vertsPerPrim) >= DD_CONTEXT->vertexCapacity)
+    {
+        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mode, depthEnabled);
+    }
+
+    if (DD_CONTEXT->vertexDest == nullptr)
+    {
+        // In single-shot mode the batch takes the rest of the bucket at once.
+        // Past the reserve, e.g. when a fallback adds vertexes we didn't count,
+        // we go back to batches of the regular size.
+        int maxCount = DEBUG_DRAW_VERTEX_BUFFER_SIZE;
+        int capacity = DEBUG_DRAW_VERTEX_BUFFER_SIZE;
+        if (DD_CONTEXT->vertexReserve >= vertsPerPrim)
+        {
+            // The check above keeps one vertex spare, which the reserve doesn't need.
+            maxCount = DD_CONTEXT->vertexReserve;
+            capacity = maxCount + 1;
+        }
+
+        void * dest = DD_CONTEXT->renderInterface->acquireVertexSpace(mode, depthEnabled, maxCount);
+        DD_CONTEXT->vertexDestAcquired = (dest != nullptr);
+
+        if (dest == nullptr)
+        {
+            dest = getVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx,) maxCount);
+            if (dest == nullptr)
+            {
+                DD_CONTEXT->vertexCapacity = 0;
+                return 0;
+            }
+        }
+
+        DD_CONTEXT->vertexDest     = dest;
+        DD_CONTEXT->vertexCapacity = capacity;
+    }
+
+    return (DD_CONTEXT->vertexCapacity - DD_CONTEXT->vertexBufferUsed - 1) / vertsPerPrim;
+}
+
+// Expands all the points of a chunk into the current batch, in the format of V.
+template<typename V>
+static void expandPointVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugPointStreams & points,
+                             const int count, const bool depthEnabled)
+{
+    for (int i = 0; i < count;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModePoints, depthEnabled, 1);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > count - i)
+        {
+            n = count - i;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n; i < end; ++i, ++verts)
+        {
+            writePointVertex(*verts, &points.positions[i * 3], points.colors[i], points.sizes[i]);
+        }
+        DD_CONTEXT->vertexBufferUsed += n;
+    }
+}
+
+// Expands all the lines of a chunk into the current batch, in the format of V.
+template<typename V>
+static void expandLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugLineStreams & lines,
+                            const int count, const bool depthEnabled)
+{
+    for (int i = 0; i < count;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled, 2);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > count - i)
+        {
+            n = count - i;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n; i < end; ++i, verts += 2)
+        {
+            writeLineVertexes(verts, &lines.positions[i * 6], lines.colors[i]);
+        }
+        DD_CONTEXT->vertexBufferUsed += n * 2;
+    }
+}
+
+//
+// World-space offsets of one pixel along the screen X and Y axes, scaled by 1/W,
+// for the point quads. Moving a point P by (x * right + y * up) * clipW(P) moves
+// it x pixels right and y pixels up on screen, at the same depth. Returns false
+// if there is no usable camera.
+//
+struct PointQuadAxes
+{
+    ddVec3 right;
+    ddVec3 up;
+};
+
+static bool computePointQuadAxes(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) PointQuadAxes & axes)
+{
+    if (!DD_CONTEXT->hasCamera || DD_CONTEXT->viewportWidth <= 0 || DD_CONTEXT->viewportHeight <= 0)
+    {
+        return false;
+    }
+
+    // Inverse of the XYZ rows of the clip transform, without the translation.
+    const float * const m = DD_CONTEXT->viewProjMatrix;
+    const float c00 = (m[5] * m[10]) - (m[9] * m[6]);
+    const float c01 = (m[9] * m[2])  - (m[1] * m[10]);
+    const float c02 = (m[1] * m[6])  - (m[5] * m[2]);
+    const float det = (m[0] * c00) + (m[4] * c01) + (m[8] * c02);
+    if (det == 0.0f)
+    {
+        return false;
+    }
+
+    // Clip X and Y span [-W, +W] over the viewport.
+    const float invDet = 1.0f / det;
+    const float scaleX = 2.0f * invDet / static_cast<float>(DD_CONTEXT->viewportWidth);
+    const float scaleY = 2.0f * invDet / static_cast<float>(DD_CONTEXT->viewportHeight);
+
+    // First column of the inverse is the cofactors of the first row, second of the second.
+    vecSet(axes.right, c00 * scaleX, c01 * scaleX, c02 * scaleX);
+    vecSet(axes.up,
+           ((m[8] * m[6])  - (m[4] * m[10])) * scaleY,
+           ((m[0] * m[10]) - (m[8] * m[2]))  * scaleY,
+           ((m[4] * m[2])  - (m[0] * m[6]))  * scaleY);
+    return true;
+}
+
+// Expands all the points of a chunk into quads of their size in pixels, in the format of V.
+template<typename V>
+static void expandPointQuadVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugPointStreams & points,
+                                 const int count, const bool depthEnabled, const PointQuadAxes & axes)
+{
+    const float * const m = DD_CONTEXT->viewProjMatrix;
+    for (int i = 0; i < count;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModePointQuads, depthEnabled, 6);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > count - i)
+        {
+            n = count - i;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n; i < end; ++i, verts += 6)
+        {
+            const float * const p = &points.positions[i * 3];
+            const float clipW = (m[3] * p[X]) + (m[7] * p[Y]) + (m[11] * p[Z]) + m[15];
+            const float half  = points.sizes[i] * 0.5f * clipW;
+
+            ddVec3 r, u, corner;
+            vecScale(r, axes.right, half);
+            vecScale(u, axes.up,    half);
+
+            // Two triangles: (bottom-left, bottom-right, top-left) and (top-left, bottom-right, top-right).
+            vecSub(corner, p, r);      vecSub(corner, corner, u); writeLineVertex(verts[0], corner, points.colors[i]);
+            vecAdd(corner, p, r);      vecSub(corner, corner, u); writeLineVertex(verts[1], corner, points.colors[i]);
+            vecSub(corner, p, r);      vecAdd(corner, corner, u); writeLineVertex(verts[2], corner, points.colors[i]);
+            verts[3] = verts[2];
+            verts[4] = verts[1];
+            vecAdd(corner, p, r);      vecAdd(corner, corner, u); writeLineVertex(verts[5], corner, points.colors[i]);
+        }
+        DD_CONTEXT->vertexBufferUsed += n * 6;
+    }
+}
+
+static void pushPointQuadVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugPointStreams & points,
+                               const int count, const bool depthEnabled, const PointQuadAxes & axes)
+{
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandPointQuadVerts<CompactVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled, axes);
+        break;
+    case VertexFormatCompactHalf :
+        expandPointQuadVerts<HalfVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled, axes);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandPointQuadVerts<CustomVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled, axes);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandPointQuadVerts<DrawVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled, axes);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+}
+
+static void pushPointVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugPointStreams & points,
+                           const int count, const bool depthEnabled)
+{
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandPointVerts<CompactPointVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        expandPointVerts<HalfVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandPointVerts<CustomVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandPointVerts<DrawVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, count, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+}
+
+static void pushLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugLineStreams & lines,
+                          const int count, const bool depthEnabled)
+{
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandLineVerts<CompactVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lines, count, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        expandLineVerts<HalfVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lines, count, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandLineVerts<CustomVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lines, count, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandLineVerts<DrawVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lines, count, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+}
+
+// Expands pairs of indexes into a line list of the vertexes they refer to, in the format of V.
+// 'positions' holds the XYZ of the vertexes, all of the same color. Used for the meshes
+// that don't go in an indexed batch.
+template<typename V>
+static void expandLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * positions,
+                                const std::uint16_t * indexes, const int indexCount,
+                                const std::uint32_t color, const bool depthEnabled)
+{
+    for (int i = 0; i < indexCount;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled, 2);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > (indexCount - i) / 2)
+        {
+            n = (indexCount - i) / 2;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n * 2; i < end; i += 2, verts += 2)
+        {
+            writeLineVertex(verts[0], &positions[indexes[i]     * 3], color);
+            writeLineVertex(verts[1], &positions[indexes[i + 1] * 3], color);
+        }
+        DD_CONTEXT->vertexBufferUsed += n * 2;
+    }
+}
+
+// Same as above, for an indexed batch the renderer has turned down.
+template<typename V>
+static void expandMeshBatchVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const V * const batchVerts,
+                                 const std::uint16_t * indexes, const int indexCount, const bool depthEnabled)
+{
+    for (int i = 0; i < indexCount;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled, 2);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > (indexCount - i) / 2)
+        {
+            n = (indexCount - i) / 2;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n * 2; i < end; ++i, ++verts)
+        {
+            *verts = batchVerts[indexes[i]];
+        }
+        DD_CONTEXT->vertexBufferUsed += n * 2;
+    }
+}
+
+// Appends a mesh to the indexed batch, which must have room for it.
+template<typename V>
+static void batchLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) V * const batchVerts,
+                               const float * positions, const int vertexCount, const std::uint16_t * indexes,
+                               const int indexCount, const std::uint32_t color)
+{
+    const int baseVertex = DD_CONTEXT->meshVertsUsed;
+
+    V * const verts = batchVerts + baseVertex;
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        writeLineVertex(verts[i], &positions[i * 3], color);
+    }
+
+    std::uint16_t * const batchIndexes = DD_CONTEXT->meshBuffers[DD_CONTEXT->currentMeshBuffer]->indexes + DD_CONTEXT->meshIndexesUsed;
+    for (int i = 0; i < indexCount; ++i)
+    {
+        batchIndexes[i] = static_cast<std::uint16_t>(baseVertex + indexes[i]);
+    }
+
+    DD_CONTEXT->meshVertsUsed   += vertexCount;
+    DD_CONTEXT->meshIndexesUsed += indexCount;
+}
+
+// Frees all indexed line batches, first waiting for the renderer
+// on the ones it might still be reading.
+static void releaseMeshBuffers(InternalContext * context)
+{
+    for (int i = 0; i < MaxStagingBuffers; ++i)
+    {
+        if (context->meshBuffers[i] != nullptr)
+        {
+            if (context->meshBufferPending[i])
+            {
+                context->renderInterface->waitBufferConsumed(&context->meshBuffers[i]->verts);
+                context->meshBufferPending[i] = false;
+            }
+            context->allocator->deallocate(context->meshBuffers[i], sizeof(MeshBuffer));
+            context->meshBuffers[i] = nullptr;
+        }
+    }
+}
+
+// Hands the indexed batch to the renderer. If it is turned down, the batch goes
+// to the line list instead and all meshes get expanded into lines from then on.
+// With more than one staging buffer, the next mesh buffer in rotation becomes
+// current, like retireVertexBuffer() does for the vertex buffers.
+static void flushMeshBatch(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const bool depthEnabled)
+{
+    if (DD_CONTEXT->meshIndexesUsed == 0)
+    {
+        return;
+    }
+
+    RenderInterface * const renderer = DD_CONTEXT->renderInterface;
+    const int current = DD_CONTEXT->currentMeshBuffer;
+    const MeshBuffer & mb = *DD_CONTEXT->meshBuffers[current];
+    const int vertexCount = DD_CONTEXT->meshVertsUsed;
+    const int indexCount  = DD_CONTEXT->meshIndexesUsed;
+
+    DD_CONTEXT->meshVertsUsed   = 0;
+    DD_CONTEXT->meshIndexesUsed = 0;
+
+    bool drawn;
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        drawn = renderer->drawIndexedLineListCompact(mb.verts.compactVerts, vertexCount, mb.indexes, indexCount, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        drawn = renderer->drawIndexedLineListHalf(mb.verts.halfVerts, vertexCount, mb.indexes, indexCount, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        drawn = renderer->drawIndexedLineListCustom(mb.verts.customVerts, vertexCount, mb.indexes, indexCount, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        drawn = renderer->drawIndexedLineList(mb.verts.drawVerts, vertexCount, mb.indexes, indexCount, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+
+    if (drawn)
+    {
+        if (DD_CONTEXT->numVertexBuffers > 1)
+        {
+            DD_CONTEXT->meshBufferPending[current] = true;
+            DD_CONTEXT->currentMeshBuffer = (current + 1) % DD_CONTEXT->numVertexBuffers;
+        }
+        return;
+    }
+
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandMeshBatchVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mb.verts.compactVerts, mb.indexes, indexCount, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        expandMeshBatchVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mb.verts.halfVerts, mb.indexes, indexCount, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandMeshBatchVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mb.verts.customVerts, mb.indexes, indexCount, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandMeshBatchVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mb.verts.drawVerts, mb.indexes, indexCount, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+
+    DD_CONTEXT->indexedLinesSupported = false;
+    releaseMeshBuffers(DD_CONTEXT);
+}
+
+static void pushLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * positions,
+                              const int vertexCount, const std::uint16_t * indexes, const int indexCount,
+                              const std::uint32_t color, const bool depthEnabled)
+{
+    // Meshes too big for a batch of their own are always expanded.
+    if (DD_CONTEXT->indexedLinesSupported && vertexCount <= MeshBatchMaxVerts && indexCount <= MeshBatchMaxIndexes)
+    {
+        if ((DD_CONTEXT->meshVertsUsed + vertexCount) > MeshBatchMaxVerts ||
+            (DD_CONTEXT->meshIndexesUsed + indexCount) > MeshBatchMaxIndexes)
+        {
+            flushMeshBatch(DD_EXPLICIT_CONTEXT_ONLY(ctx,) depthEnabled);
+        }
+
+        const int current = DD_CONTEXT->currentMeshBuffer;
+        MeshBuffer *& mb  = DD_CONTEXT->meshBuffers[current];
+
+        if (DD_CONTEXT->indexedLinesSupported && mb == nullptr)
+        {
+            mb = static_cast<MeshBuffer *>(DD_CONTEXT->allocator->allocate(sizeof(MeshBuffer), alignof(MeshBuffer)));
+        }
+
+        if (DD_CONTEXT->indexedLinesSupported && mb != nullptr)
+        {
+            // Only set on an empty batch, so we wait before writing its first vertex.
+            if (DD_CONTEXT->meshBufferPending[current])
+            {
+                DD_CONTEXT->renderInterface->waitBufferConsumed(&mb->verts);
+                DD_CONTEXT->meshBufferPending[current] = false;
+            }
+
+            VertexBuffer & vb = mb->verts;
+            switch (DD_CONTEXT->vertexFormat)
+            {
+            case VertexFormatCompact :
+                batchLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) vb.compactVerts, positions, vertexCount, indexes, indexCount, color);
+                break;
+            case VertexFormatCompactHalf :
+                batchLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) vb.halfVerts, positions, vertexCount, indexes, indexCount, color);
+                break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+            case VertexFormatCustom :
+                batchLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) vb.customVerts, positions, vertexCount, indexes, indexCount, color);
+                break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+            default :
+                batchLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) vb.drawVerts, positions, vertexCount, indexes, indexCount, color);
+                break;
+            } // switch (DD_CONTEXT->vertexFormat)
+            return;
+        }
+    }
+
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandLineMeshVerts<CompactVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, indexes, indexCount, color, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        expandLineMeshVerts<HalfVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, indexes, indexCount, color, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandLineMeshVerts<CustomVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, indexes, indexCount, color, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandLineMeshVerts<DrawVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, indexes, indexCount, color, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+}
+
+// Expands a line strip into the line list, in the format of V.
+template<typename V>
+static void expandLineStripVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * positions,
+                                 const int vertexCount, const std::uint32_t color, const bool depthEnabled)
+{
+    for (int i = 0; i < vertexCount - 1;)
+    {
+        int n = beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled, 2);
+        if (n <= 0)
+        {
+            return;
+        }
+        if (n > vertexCount - 1 - i)
+        {
+            n = vertexCount - 1 - i;
+        }
+
+        V * verts = static_cast<V *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (const int end = i + n; i < end; ++i, verts += 2)
+        {
+            writeLineVertexes(verts, &positions[i * 3], color);
+        }
+        DD_CONTEXT->vertexBufferUsed += n * 2;
+    }
+}
+
+static void pushLineStripVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * positions,
+                               const int vertexCount, const std::uint32_t color, const bool depthEnabled)
+{
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        expandLineStripVerts<CompactVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, vertexCount, color, depthEnabled);
+        break;
+    case VertexFormatCompactHalf :
+        expandLineStripVerts<HalfVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, vertexCount, color, depthEnabled);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        expandLineStripVerts<CustomVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, vertexCount, color, depthEnabled);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        expandLineStripVerts<DrawVertex>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, vertexCount, color, depthEnabled);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+}
+
+template<typename V>
+static void writeLineStripVerts(V * const verts, const float * positions, const int count, const std::uint32_t color)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        writeLineVertex(verts[i], &positions[i * 3], color);
+    }
+}
+
+// Hands a line strip to the renderer, in pieces that fit in our vertex buffer.
+// The line list batch must be empty, since the pieces go through the same buffer.
+// If the renderer turns strips down, the rest is expanded into the line list.
+static void drawLineStrip(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * positions,
+                          const int vertexCount, const std::uint32_t color, const bool depthEnabled)
+{
+    RenderInterface * const renderer = DD_CONTEXT->renderInterface;
+
+    int start = 0;
+    while (DD_CONTEXT->lineStripsSupported && start < vertexCount - 1)
+    {
+        void * const vb = getVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DEBUG_DRAW_VERTEX_BUFFER_SIZE);
+        if (vb == nullptr)
+        {
+            return;
+        }
+
+        int count = vertexCount - start;
+        if (count > DEBUG_DRAW_VERTEX_BUFFER_SIZE)
+        {
+            count = DEBUG_DRAW_VERTEX_BUFFER_SIZE;
+        }
+
+        const float * const piece = &positions[start * 3];
+        bool drawn;
+        switch (DD_CONTEXT->vertexFormat)
+        {
+        case VertexFormatCompact :
+            writeLineStripVerts(static_cast<CompactVertex *>(vb), piece, count, color);
+            drawn = renderer->drawLineStripCompact(static_cast<CompactVertex *>(vb), count, depthEnabled);
+            break;
+        case VertexFormatCompactHalf :
+            writeLineStripVerts(static_cast<HalfVertex *>(vb), piece, count, color);
+            drawn = renderer->drawLineStripHalf(static_cast<HalfVertex *>(vb), count, depthEnabled);
+            break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        case VertexFormatCustom :
+            writeLineStripVerts(static_cast<CustomVertex *>(vb), piece, count, color);
+            drawn = renderer->drawLineStripCustom(static_cast<CustomVertex *>(vb), count, depthEnabled);
+            break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+        default :
+            writeLineStripVerts(static_cast<DrawVertex *>(vb), piece, count, color);
+            drawn = renderer->drawLineStrip(static_cast<DrawVertex *>(vb), count, depthEnabled);
+            break;
+        } // switch (DD_CONTEXT->vertexFormat)
+
+        if (!drawn)
+        {
+            DD_CONTEXT->lineStripsSupported = false;
+            break;
+        }
+        retireVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+
+        // The next piece starts at the last vertex of this one.
+        start += count - 1;
+    }
+
+    if (start < vertexCount - 1)
+    {
+        pushLineStripVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) &positions[start * 3], vertexCount - start, color, depthEnabled);
+    }
+}
+
+// Expands a glyph into two triangles of the text vertex batch.
+static void pushGlyphVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const GlyphInstance & glyph, ddVec3_In color)
+{
+    // Make room for one more glyph (2 tris):
+    if (beginDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeText, false, 6) <= 0)
+    {
+        return;
+    }
+
+    const float scaleU = static_cast<float>(getFontCharSet().bitmapWidth);
+    const float scaleV = static_cast<float>(getFontCharSet().bitmapHeight);
+    const float chrW   = static_cast<float>(glyph.texelWidth)  * glyph.scale;
+    const float chrH   = static_cast<float>(glyph.texelHeight) * glyph.scale;
+    const float u0     = (glyph.texelX + 0.5f) / scaleU;
+    const float v0     = (glyph.texelY + 0.5f) / scaleV;
+    const float u1     = u0 + (static_cast<float>(glyph.texelWidth)  / scaleU);
+    const float v1     = v0 + (static_cast<float>(glyph.texelHeight) / scaleV);
+
+    DrawVertex verts[4];
+    verts[0].glyph.x = glyph.x;
+    verts[0].glyph.y = glyph.y;
+    verts[0].glyph.u = u0;
+    verts[0].glyph.v = v0;
+    verts[1].glyph.x = glyph.x;
+    verts[1].glyph.y = glyph.y + chrH;
+    verts[1].glyph.u = u0;
+    verts[1].glyph.v = v1;
+    verts[2].glyph.x = glyph.x + chrW;
+    verts[2].glyph.y = glyph.y;
+    verts[2].glyph.u = u1;
+    verts[2].glyph.v = v0;
+    verts[3].glyph.x = glyph.x + chrW;
+    verts[3].glyph.y = glyph.y + chrH;
+    verts[3].glyph.u = u1;
+    verts[3].glyph.v = v1;
+
+    static const int indexes[6] = { 0, 1, 2, 2, 1, 3 };
+
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    if (DD_CONTEXT->vertexFormat == VertexFormatCustom)
+    {
+        CustomVertex * const customDest = static_cast<CustomVertex *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+        for (int i = 0; i < 6; ++i)
+        {
+            const DrawVertex & v = verts[indexes[i]];
+            VertexWriter<CustomVertex>::writeGlyph(customDest[i], v.glyph.x, v.glyph.y, v.glyph.u, v.glyph.v, glyph.color);
+        }
+        DD_CONTEXT->vertexBufferUsed += 6;
+        return;
+    }
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+
+    DrawVertex * const dest = static_cast<DrawVertex *>(DD_CONTEXT->vertexDest) + DD_CONTEXT->vertexBufferUsed;
+    for (int i = 0; i < 6; ++i)
+    {
+        dest[i].glyph   = verts[indexes[i]].glyph;
+        dest[i].glyph.r = color[X];
+        dest[i].glyph.g = color[Y];
+        dest[i].glyph.b = color[Z];
+    }
+    DD_CONTEXT->vertexBufferUsed += 6;
+}
+
+// Frees all glyph instance batches, first waiting for the renderer
+// on the ones it might still be reading.
+static void releaseGlyphBuffers(InternalContext * context)
+{
+    for (int i = 0; i < MaxStagingBuffers; ++i)
+    {
+        if (context->glyphBuffers[i] != nullptr)
+        {
+            if (context->glyphBufferPending[i])
+            {
+                context->renderInterface->waitBufferConsumed(context->glyphBuffers[i]);
+                context->glyphBufferPending[i] = false;
+            }
+            context->allocator->deallocate(context->glyphBuffers[i], sizeof(GlyphInstance) * GlyphBatchMaxGlyphs);
+            context->glyphBuffers[i] = nullptr;
+        }
+    }
+}
+
+// Hands the glyph batch to the renderer. If it turns instances down,
+// the batch goes to the text vertexes instead, and so does all text
+// from then on. Glyph buffers rotate like the mesh buffers.
+static void flushGlyphBatch(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (DD_CONTEXT->glyphsUsed == 0)
+    {
+        return;
+    }
+
+    const int current = DD_CONTEXT->currentGlyphBuffer;
+    const GlyphInstance * const glyphs = DD_CONTEXT->glyphBuffers[current];
+    const int count = DD_CONTEXT->glyphsUsed;
+    DD_CONTEXT->glyphsUsed = 0;
+
+    if (DD_CONTEXT->renderInterface->drawGlyphInstances(glyphs, count, DD_CONTEXT->glyphTexHandle))
+    {
+        if (DD_CONTEXT->numVertexBuffers > 1)
+        {
+            DD_CONTEXT->glyphBufferPending[current] = true;
+            DD_CONTEXT->currentGlyphBuffer = (current + 1) % DD_CONTEXT->numVertexBuffers;
+        }
+        return;
+    }
+
+    DD_CONTEXT->glyphInstancesSupported = false;
+    for (int i = 0; i < count; ++i)
+    {
+        ddVec3 color;
+        color[X] = unpackColorChannel(glyphs[i].color, 0);
+        color[Y] = unpackColorChannel(glyphs[i].color, 8);
+        color[Z] = unpackColorChannel(glyphs[i].color, 16);
+        pushGlyphVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) glyphs[i], color);
+    }
+
+    releaseGlyphBuffers(DD_CONTEXT);
+}
+
+static void pushGlyph(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const GlyphInstance & glyph, ddVec3_In color)
+{
+    if (DD_CONTEXT->glyphInstancesSupported && DD_CONTEXT->glyphsUsed == GlyphBatchMaxGlyphs)
+    {
+        flushGlyphBatch(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    }
+
+    const int current = DD_CONTEXT->currentGlyphBuffer;
+    GlyphInstance *& glyphs = DD_CONTEXT->glyphBuffers[current];
+
+    if (DD_CONTEXT->glyphInstancesSupported && glyphs == nullptr)
+    {
+        glyphs = static_cast<GlyphInstance *>(
+            DD_CONTEXT->allocator->allocate(sizeof(GlyphInstance) * GlyphBatchMaxGlyphs, alignof(GlyphInstance)));
+    }
+
+    if (DD_CONTEXT->glyphInstancesSupported && glyphs != nullptr)
+    {
+        if (DD_CONTEXT->glyphBufferPending[current])
+        {
+            DD_CONTEXT->renderInterface->waitBufferConsumed(glyphs);
+            DD_CONTEXT->glyphBufferPending[current] = false;
+        }
+        glyphs[DD_CONTEXT->glyphsUsed++] = glyph;
+        return;
+    }
+
+    // Also the fallback if we couldn't allocate the batch.
+    pushGlyphVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) glyph, color);
+}
+
+static void pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) float x, float y,
+                             const char * text, ddVec3_In color, const float scaling)
+{
+    // Invariants for all characters:
+    const float initialX    = x;
+    const float fixedWidth  = static_cast<float>(getFontCharSet().charWidth);
+    const float fixedHeight = static_cast<float>(getFontCharSet().charHeight);
+    const float tabW        = fixedWidth  * 4.0f * scaling; // TAB = 4 spaces.
+    const float chrW        = fixedWidth  * scaling;
+    const float chrH        = fixedHeight * scaling;
+
+    GlyphInstance glyph;
+    glyph.texelWidth  = static_cast<std::uint16_t>(getFontCharSet().charWidth);
+    glyph.texelHeight = static_cast<std::uint16_t>(getFontCharSet().charHeight);
+    glyph.scale       = scaling;
+    glyph.color       = packColor(color);
+
+    for (; *text != '\0'; ++text)
+    {
+        const int charVal = *text;
+        if (charVal >= FontCharSet::MaxChars)
+        {
+            continue;
+        }
+        if (charVal == ' ')
+        {
+            x += chrW;
+            continue;
+        }
+        if (charVal == '\t')
+        {
+            x += tabW;
+            continue;
+        }
+        if (charVal == '\n')
+        {
+            y += chrH;
+            x  = initialX;
+            continue;
+        }
+
+        const FontChar fontChar = getFontCharSet().chars[charVal];
+        glyph.x      = x;
+        glyph.y      = y;
+        glyph.texelX = fontChar.x;
+        glyph.texelY = fontChar.y;
+
+        pushGlyph(DD_EXPLICIT_CONTEXT_ONLY(ctx,) glyph, color);
+        x += chrW;
+    }
+}
+
+static float calcTextWidth(const char * text, const float scaling)
+{
+    const float fixedWidth = static_cast<float>(getFontCharSet().charWidth);
+    const float tabW = fixedWidth * 4.0f * scaling; // TAB = 4 spaces.
+    const float chrW = fixedWidth * scaling;
 
     float x = 0.0f;
     for (; *text != '\0'; ++text)
     {
-        // Tabs are handled differently (4 spaces)
-        if (*text == '\t')
+        // Tabs are handled differently (4 spaces)
+        if (*text == '\t')
+        {
+            x += tabW;
+        }
+        else // Non-tab char (including whitespace)
+        {
+            x += chrW;
+        }
+    }
+
+    return x;
+}
+
+// Number of glyphs pushStringGlyphs() emits for a string.
+static int countGlyphs(const char * text)
+{
+    int count = 0;
+    for (; *text != '\0'; ++text)
+    {
+        const int charVal = *text;
+        if (charVal < FontCharSet::MaxChars && charVal != ' ' && charVal != '\t' && charVal != '\n')
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Vertexes of the text bucket, for single-shot mode.
+// Glyphs sent as instances don't take any.
+static int countTextVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (DD_CONTEXT->glyphInstancesSupported)
+    {
+        return 0;
+    }
+
+    int count = 0;
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        const DebugQueue & queue = DD_CONTEXT->debugStrings[priority];
+        int b;
+        for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+        {
+            const DebugString * const debugStrings = DebugStringStreams(chunk, chunk->capacity).strings;
+            const char * const textBase = (b < 0) ? DD_CONTEXT->transientText.data : DD_CONTEXT->timedText.data;
+            for (int i = 0; i < chunk->count; ++i)
+            {
+                count += countGlyphs(textBase + debugStrings[i].textOffset) * 6;
+            }
+        }
+    }
+    return count;
+}
+
+static void drawDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (DD_CONTEXT->singleShot)
+    {
+        DD_CONTEXT->vertexReserve = countTextVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    }
+
+    // Higher priorities last, so they end up on top.
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        const DebugQueue & queue = DD_CONTEXT->debugStrings[priority];
+        if (queue.count == 0)
+        {
+            continue;
+        }
+
+        int b;
+        for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+        {
+            const DebugString * const debugStrings = DebugStringStreams(chunk, chunk->capacity).strings;
+            const char * const textBase = (b < 0) ? DD_CONTEXT->transientText.data : DD_CONTEXT->timedText.data;
+            const int count = chunk->count;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const DebugString & dstr = debugStrings[i];
+                const char * const text  = textBase + dstr.textOffset;
+                if (dstr.centered)
+                {
+                    // 3D Labels are centered at the point of origin, e.g. center-aligned.
+                    const float offset = calcTextWidth(text, dstr.scaling) * 0.5f;
+                    pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ctx,) dstr.posX - offset, dstr.posY, text, dstr.color, dstr.scaling);
+                }
+                else
+                {
+                    // Left-aligned
+                    pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ctx,) dstr.posX, dstr.posY, text, dstr.color, dstr.scaling);
+                }
+            }
+        }
+    }
+
+    flushGlyphBatch(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeText, false);
+    DD_CONTEXT->vertexReserve = 0;
+}
+
+static void drawDebugPoints(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    // Without a camera, points go to the point lists even if quads were asked for.
+    PointQuadAxes quadAxes;
+    const bool quads = DD_CONTEXT->pointQuads && computePointQuadAxes(DD_EXPLICIT_CONTEXT_ONLY(ctx,) quadAxes);
+
+    // Points with depth test ENABLED first, then the ones with depth DISABLED.
+    // Within each, higher priorities last, so they end up on top.
+    for (int depthEnabled = 1; depthEnabled >= 0; --depthEnabled)
+    {
+        if (DD_CONTEXT->singleShot)
+        {
+            int count = 0;
+            for (int priority = 0; priority < DrawPriorityCount; ++priority)
+            {
+                count += DD_CONTEXT->debugPoints[priority][depthEnabled].count;
+            }
+            DD_CONTEXT->vertexReserve = count * (quads ? 6 : 1);
+        }
+
+        for (int priority = 0; priority < DrawPriorityCount; ++priority)
+        {
+            const DebugQueue & queue = DD_CONTEXT->debugPoints[priority][depthEnabled];
+            if (queue.count == 0)
+            {
+                continue;
+            }
+
+            int b;
+            for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+            {
+                if (quads)
+                {
+                    pushPointQuadVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DebugPointStreams(chunk, chunk->capacity), chunk->count,
+                                       (depthEnabled != 0), quadAxes);
+                }
+                else
+                {
+                    pushPointVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DebugPointStreams(chunk, chunk->capacity), chunk->count, (depthEnabled != 0));
+                }
+            }
+        }
+        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) (quads ? DrawModePointQuads : DrawModePoints), (depthEnabled != 0));
+        DD_CONTEXT->vertexReserve = 0;
+    }
+}
+
+// Pushes the meshes of a queue to the line list or indexed batch. Line strips are
+// left for drawDebugStrips() if the renderer takes them, returns how many were left.
+static int drawDebugMeshes(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugQueue & queue, const bool depthEnabled)
+{
+    int numStrips = 0;
+    int b;
+    for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+    {
+        const DebugLineMesh * const meshes = DebugMeshStreams(chunk, chunk->capacity).meshes;
+        const char * const geometryBase = (b < 0) ? DD_CONTEXT->transientGeometry.data : DD_CONTEXT->timedGeometry.data;
+        const int count = chunk->count;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const DebugLineMesh & mesh = meshes[i];
+            const float * const positions = reinterpret_cast<const float *>(geometryBase + mesh.geometryOffset);
+
+            if (mesh.indexCount == 0)
+            {
+                if (DD_CONTEXT->lineStripsSupported)
+                {
+                    ++numStrips;
+                }
+                else
+                {
+                    pushLineStripVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, mesh.vertexCount, mesh.color, depthEnabled);
+                }
+                continue;
+            }
+
+            const std::uint16_t * const indexes = reinterpret_cast<const std::uint16_t *>(positions + mesh.vertexCount * 3);
+            pushLineMeshVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) positions, mesh.vertexCount, indexes,
+                              mesh.indexCount, mesh.color, depthEnabled);
+        }
+    }
+    return numStrips;
+}
+
+// Draws the line strips of a queue, one RenderInterface call each.
+static void drawDebugStrips(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugQueue & queue, const bool depthEnabled)
+{
+    int b;
+    for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+    {
+        const DebugLineMesh * const meshes = DebugMeshStreams(chunk, chunk->capacity).meshes;
+        const char * const geometryBase = (b < 0) ? DD_CONTEXT->transientGeometry.data : DD_CONTEXT->timedGeometry.data;
+        const int count = chunk->count;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const DebugLineMesh & mesh = meshes[i];
+            if (mesh.indexCount == 0)
+            {
+                drawLineStrip(DD_EXPLICIT_CONTEXT_ONLY(ctx,) reinterpret_cast<const float *>(geometryBase + mesh.geometryOffset),
+                              mesh.vertexCount, mesh.color, depthEnabled);
+            }
+        }
+    }
+}
+
+// Hands the instance queues of each shape to the renderer, one call per queue chunk.
+static void drawDebugInstances(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugQueue queues[ShapeMeshCount],
+                               const bool depthEnabled)
+{
+    bool linesFlushed = false;
+    for (int shape = 0; shape < ShapeMeshCount; ++shape)
+    {
+        const DebugQueue & queue = queues[shape];
+        if (queue.count == 0)
+        {
+            continue;
+        }
+
+        // Keep them on top of the lines of lower priorities.
+        if (!linesFlushed)
+        {
+            flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled);
+            linesFlushed = true;
+        }
+
+        int b;
+        for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+        {
+            DD_CONTEXT->renderInterface->drawShapeInstances(DD_CONTEXT->shapeMeshes[shape],
+                                                            ShapeInstanceStreams(chunk, chunk->capacity).instances,
+                                                            chunk->count, depthEnabled);
+        }
+    }
+}
+
+// Vertexes the meshes of a queue add to the line list, for single-shot mode.
+// Those that go to the indexed batch or as line strips don't take any.
+static int countMeshLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DebugQueue & queue)
+{
+    int count = 0;
+    int b;
+    for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+    {
+        const DebugLineMesh * const meshes = DebugMeshStreams(chunk, chunk->capacity).meshes;
+        for (int i = 0; i < chunk->count; ++i)
+        {
+            const DebugLineMesh & mesh = meshes[i];
+            if (mesh.indexCount == 0)
+            {
+                count += DD_CONTEXT->lineStripsSupported ? 0 : (mesh.vertexCount - 1) * 2;
+            }
+            else if (!DD_CONTEXT->indexedLinesSupported || mesh.vertexCount > MeshBatchMaxVerts ||
+                     mesh.indexCount > MeshBatchMaxIndexes)
+            {
+                count += mesh.indexCount;
+            }
+        }
+    }
+    return count;
+}
+
+template<typename V>
+static void writeBucketLineVerts(V * verts, const QueueBucket & bucket)
+{
+    for (QueueChunk * chunk = bucket.head; chunk != nullptr; chunk = chunk->next)
+    {
+        const DebugLineStreams lines(chunk, chunk->capacity);
+        for (int i = 0; i < chunk->count; ++i, verts += 2)
+        {
+            writeLineVertexes(verts, &lines.positions[i * 6], lines.colors[i]);
+        }
+    }
+}
+
+// Draws a bucket of timed lines as a persistent range, expanding its vertexes
+// only if the renderer doesn't have the current version. Returns false if the
+// renderer turned it down.
+static bool drawBucketRange(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) QueueBucket & bucket, const bool depthEnabled)
+{
+    RenderInterface * const renderer = DD_CONTEXT->renderInterface;
+    const int count = bucket.count * 2;
+
+    if (bucket.rangeId != 0 && bucket.rangeVersion == bucket.version)
+    {
+        return renderer->drawPersistentRange(bucket.rangeId, bucket.version, nullptr, count, depthEnabled);
+    }
+
+    void * const verts = getVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx,) count);
+    if (verts == nullptr)
+    {
+        return true; // Dropped, like the batches that fail to allocate.
+    }
+
+    switch (DD_CONTEXT->vertexFormat)
+    {
+    case VertexFormatCompact :
+        writeBucketLineVerts(static_cast<CompactVertex *>(verts), bucket);
+        break;
+    case VertexFormatCompactHalf :
+        writeBucketLineVerts(static_cast<HalfVertex *>(verts), bucket);
+        break;
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    case VertexFormatCustom :
+        writeBucketLineVerts(static_cast<CustomVertex *>(verts), bucket);
+        break;
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+    default :
+        writeBucketLineVerts(static_cast<DrawVertex *>(verts), bucket);
+        break;
+    } // switch (DD_CONTEXT->vertexFormat)
+
+    const std::uint32_t id = (bucket.rangeId != 0) ? bucket.rangeId : DD_CONTEXT->nextRangeId;
+    if (!renderer->drawPersistentRange(id, bucket.version, verts, count, depthEnabled))
+    {
+        return false;
+    }
+
+    if (bucket.rangeId == 0)
+    {
+        bucket.rangeId = DD_CONTEXT->nextRangeId++;
+    }
+    bucket.rangeVersion = bucket.version;
+    retireVertexBuffer(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    return true;
+}
+
+// Pushes the lines of a queue to the line list, with the timed ones
+// drawn as persistent ranges instead if the renderer supports them.
+static void drawQueuedLines(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) DebugQueue & queue, const bool depthEnabled)
+{
+    if (!DD_CONTEXT->persistentRangesSupported)
+    {
+        int b;
+        for (QueueChunk * chunk = queueFirstChunk(queue, b); chunk != nullptr; chunk = queueNextChunk(queue, chunk, b))
+        {
+            pushLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DebugLineStreams(chunk, chunk->capacity), chunk->count, depthEnabled);
+        }
+        return;
+    }
+
+    for (QueueChunk * chunk = queue.transient.head; chunk != nullptr; chunk = chunk->next)
+    {
+        pushLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DebugLineStreams(chunk, chunk->capacity), chunk->count, depthEnabled);
+    }
+
+    bool linesFlushed = false;
+    for (int b = 0; b < queue.numBuckets; ++b)
+    {
+        QueueBucket & bucket = queue.buckets[b];
+        if (bucket.count == 0)
+        {
+            continue;
+        }
+
+        if (DD_CONTEXT->persistentRangesSupported)
+        {
+            // Keep them on top of the lines of lower priorities.
+            if (!linesFlushed)
+            {
+                flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, depthEnabled);
+                linesFlushed = true;
+            }
+            if (drawBucketRange(DD_EXPLICIT_CONTEXT_ONLY(ctx,) bucket, depthEnabled))
+            {
+                continue;
+            }
+            DD_CONTEXT->persistentRangesSupported = false;
+        }
+
+        for (QueueChunk * chunk = bucket.head; chunk != nullptr; chunk = chunk->next)
+        {
+            pushLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DebugLineStreams(chunk, chunk->capacity), chunk->count, depthEnabled);
+        }
+    }
+}
+
+static void drawDebugLines(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    // Lines with depth test ENABLED first, then the ones with depth DISABLED.
+    // Within each, higher priorities last, so they end up on top.
+    for (int depthEnabled = 1; depthEnabled >= 0; --depthEnabled)
+    {
+        if (DD_CONTEXT->singleShot)
         {
-            x += tabW;
+            int count = 0;
+            for (int priority = 0; priority < DrawPriorityCount; ++priority)
+            {
+                const DebugQueue & lines = DD_CONTEXT->debugLines[priority][depthEnabled];
+                count += (DD_CONTEXT->persistentRangesSupported ? lines.transient.count : lines.count) * 2;
+                count += countMeshLineVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugMeshes[priority][depthEnabled]);
+            }
+            DD_CONTEXT->vertexReserve = count;
         }
-        else // Non-tab char (including whitespace)
+
+        for (int priority = 0; priority < DrawPriorityCount; ++priority)
         {
-            x += chrW;
+            DebugQueue & queue = DD_CONTEXT->debugLines[priority][depthEnabled];
+            if (queue.count != 0)
+            {
+                drawQueuedLines(DD_EXPLICIT_CONTEXT_ONLY(ctx,) queue, (depthEnabled != 0));
+            }
+
+            const DebugQueue & meshes = DD_CONTEXT->debugMeshes[priority][depthEnabled];
+            int numStrips = 0;
+            if (meshes.count != 0)
+            {
+                numStrips = drawDebugMeshes(DD_EXPLICIT_CONTEXT_ONLY(ctx,) meshes, (depthEnabled != 0));
+            }
+
+            // Indexed meshes and line strips are drawn on their own,
+            // after the lines of this and the lower priorities.
+            if (DD_CONTEXT->meshIndexesUsed != 0 || numStrips != 0)
+            {
+                flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, (depthEnabled != 0));
+                flushMeshBatch(DD_EXPLICIT_CONTEXT_ONLY(ctx,) (depthEnabled != 0));
+            }
+            if (numStrips != 0)
+            {
+                // The indexed batch may have fallen back to the line list.
+                flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, (depthEnabled != 0));
+                drawDebugStrips(DD_EXPLICIT_CONTEXT_ONLY(ctx,) meshes, (depthEnabled != 0));
+            }
+
+            drawDebugInstances(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugInstances[priority][depthEnabled],
+                               (depthEnabled != 0));
         }
+        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, (depthEnabled != 0));
+        DD_CONTEXT->vertexReserve = 0;
     }
+}
 
-    return x;
+// Removes the expired elements of a bucket that still has live ones.
+template<typename S>
+static void compactBucket(DebugQueue & queue, QueueBucket & bucket, const std::int64_t time)
+{
+    const int capacity    = bucket.head->capacity; // The same for all chunks of a list.
+    QueueChunk * dstChunk = bucket.head;
+    S dst(dstChunk, capacity);
+    std::int64_t minExpiry = bucket.maxExpiry;
+    int dstIndex = 0;
+    int index    = 0;
+
+    // Concatenate elements that still need to be draw on future frames.
+    // The write position never gets ahead of the read position, so
+    // the chunks can be compacted in place. Only the expiry stream is
+    // read for elements that get dropped.
+    for (QueueChunk * srcChunk = bucket.head; srcChunk != nullptr; srcChunk = srcChunk->next)
+    {
+        const S src(srcChunk, capacity);
+        const int count = srcChunk->count;
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (src.expiry[i] > time)
+            {
+                if (dstIndex == capacity)
+                {
+                    dstChunk->count = dstIndex;
+                    dstChunk = dstChunk->next;
+                    dst = S(dstChunk, capacity);
+                    dstIndex = 0;
+                }
+
+                if (dstChunk != srcChunk || dstIndex != i)
+                {
+                    src.move(i, dst, dstIndex);
+                }
+                if (src.expiry[i] < minExpiry)
+                {
+                    minExpiry = src.expiry[i];
+                }
+                ++dstIndex;
+                ++index;
+            }
+        }
+    }
+
+    // Give the chunks past the new tail back to the free list:
+    if (dstChunk->next != nullptr)
+    {
+        poolFreeChunks(*queue.pool, dstChunk->next, bucket.tail);
+        dstChunk->next = nullptr;
+    }
+
+    dstChunk->count    = dstIndex;
+    bucket.tail        = dstChunk;
+    bucket.minExpiry   = minExpiry;
+    queue.count       -= bucket.count - index;
+    queue.pool->count -= bucket.count - index;
+    bucket.count       = index;
+    ++bucket.version;
 }
 
-static void drawDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+// Tells the renderer the persistent range of a bucket is gone, if it had one.
+static void releaseBucketRange(RenderInterface * renderer, QueueBucket & bucket)
+{
+    if (bucket.rangeId != 0)
+    {
+        renderer->releasePersistentRange(bucket.rangeId);
+        bucket.rangeId = 0;
+    }
+}
+
+// Same for all the buckets of a queue, before it gets reset.
+static void releaseQueueRanges(RenderInterface * renderer, DebugQueue & queue)
 {
-    const int count = DD_CONTEXT->debugStringsCount;
-    if (count == 0)
+    for (int b = 0; b < queue.numBuckets; ++b)
     {
+        releaseBucketRange(renderer, queue.buckets[b]);
+    }
+}
+
+template<typename S>
+static void clearDebugQueue(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) DebugQueue & queue)
+{
+    const std::int64_t time = DD_CONTEXT->currentTimeMillis;
+    if (time == 0 || queue.count == 0)
+    {
+        releaseQueueRanges(DD_CONTEXT->renderInterface, queue);
+        queueReset(queue);
         return;
     }
 
-    const DebugString * const debugStrings = DD_CONTEXT->debugStrings;
+    // Transient elements all expire on the frame they were drawn, unless the
+    // clock went backwards, so this is normally just a chunk list splice.
+    QueueBucket & transient = queue.transient;
+    if (transient.count != 0)
+    {
+        if (transient.maxExpiry <= time)
+        {
+            queueRecycleBucket(queue, transient);
+        }
+        else
+        {
+            compactBucket<S>(queue, transient, time);
+        }
+    }
 
-    for (int i = 0; i < count; ++i)
+    // Buckets are sorted by expiry, so we can stop at the first one
+    // that has nothing expired. Only the last bucket visited can still
+    // have live elements, all the previous ones are recycled whole.
+    int numVisited = 0;
+    int numEmptied = 0;
+    for (; numVisited < queue.numBuckets; ++numVisited)
     {
-        const DebugString & dstr = debugStrings[i];
-        if (dstr.centered)
+        QueueBucket & bucket = queue.buckets[numVisited];
+        if (bucket.minExpiry > time)
+        {
+            break;
+        }
+
+        if (bucket.maxExpiry <= time)
         {
-            // 3D Labels are centered at the point of origin, e.g. center-aligned.
-            const float offset = calcTextWidth(dstr.text.c_str(), dstr.scaling) * 0.5f;
-            pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ctx,) dstr.posX - offset, dstr.posY, dstr.text.c_str(), dstr.color, dstr.scaling);
+            releaseBucketRange(DD_CONTEXT->renderInterface, bucket);
+            queueRecycleBucket(queue, bucket);
+            ++numEmptied;
         }
         else
         {
-            // Left-aligned
-            pushStringGlyphs(DD_EXPLICIT_CONTEXT_ONLY(ctx,) dstr.posX, dstr.posY, dstr.text.c_str(), dstr.color, dstr.scaling);
+            // The range of dates may be stale after an eviction,
+            // in which case nothing might be left.
+            compactBucket<S>(queue, bucket, time);
+            if (bucket.count == 0)
+            {
+                releaseBucketRange(DD_CONTEXT->renderInterface, bucket);
+                ++numEmptied;
+            }
+        }
+    }
+
+    // Drop the buckets that are now empty from the front of the array.
+    // A bucket emptied by compaction still holds its tail chunk, so
+    // each one is recycled before it goes, which is a no-op for the others.
+    if (numEmptied > 0)
+    {
+        int dst = 0;
+        for (int i = 0; i < queue.numBuckets; ++i)
+        {
+            if (i >= numVisited || queue.buckets[i].count != 0)
+            {
+                queue.buckets[dst++] = queue.buckets[i];
+            }
+            else
+            {
+                releaseBucketRange(DD_CONTEXT->renderInterface, queue.buckets[i]);
+                queueRecycleBucket(queue, queue.buckets[i]);
+            }
+        }
+        queue.numBuckets = dst;
+        queue.lastBucket = 0;
+    }
+}
+
+// Pushes to queues[priority * queuesPerPriority + index], which all share the
+// same pool. If the pool is exhausted, the list of the lowest priority below the
+// new element that expires first loses one element and the push is retried.
+// 'numEvicted' is incremented for each element dropped to make room.
+template<typename S>
+static QueueChunk * queuePushEvicting(DebugQueue * const queues, const int queuesPerPriority, const int index,
+                                      const int priority, const std::int64_t expiry, const bool transient,
+                                      std::int64_t & numEvicted)
+{
+    DebugQueue & queue = queues[priority * queuesPerPriority + index];
+    QueueChunk * chunk = queuePush<S>(queue, expiry, transient);
+    if (chunk != nullptr)
+    {
+        return chunk;
+    }
+
+    for (int p = 0; p < priority; ++p)
+    {
+        DebugQueue  * victimQueue  = nullptr;
+        QueueBucket * victimBucket = nullptr;
+        for (int i = 0; i < queuesPerPriority; ++i)
+        {
+            DebugQueue & candidate = queues[p * queuesPerPriority + i];
+            QueueBucket * bucket = queueFirstToExpire(candidate);
+            if (bucket != nullptr && (victimBucket == nullptr || bucket->minExpiry < victimBucket->minExpiry))
+            {
+                victimQueue  = &candidate;
+                victimBucket = bucket;
+            }
+        }
+
+        if (victimBucket != nullptr)
+        {
+            queueEvictElement(*victimQueue, *victimBucket);
+            ++numEvicted;
+            return queuePush<S>(queue, expiry, transient);
+        }
+    }
+    return nullptr;
+}
+
+// Appends up to 'maxCount' more elements of the same expiry date to the chunk
+// a push to 'queue' just returned, as far as it has room, for the bulk draws.
+// Their expiry is set. Returns how many were appended at the end of the chunk.
+template<typename S>
+static int queueAppend(DebugQueue & queue, QueueChunk * const chunk, const std::int64_t expiry,
+                       const bool transient, const int maxCount)
+{
+    ChunkPool & pool = *queue.pool;
+    int count = chunk->capacity - chunk->count;
+    if (count > maxCount)
+    {
+        count = maxCount;
+    }
+    if (pool.maxCount != 0 && count > pool.maxCount - pool.count)
+    {
+        count = pool.maxCount - pool.count;
+    }
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    // The push left the bucket of that date as the last one used.
+    QueueBucket & bucket = transient ? queue.transient : queue.buckets[queue.lastBucket];
+
+    std::int64_t * const expiryStream = S(chunk, chunk->capacity).expiry;
+    for (int i = chunk->count; i < chunk->count + count; ++i)
+    {
+        expiryStream[i] = expiry;
+    }
+
+    ++bucket.version;
+    bucket.count += count;
+    queue.count  += count;
+    pool.count   += count;
+    chunk->count += count;
+    return count;
+}
+
+// Copies the text of the live timed strings into the scratch arena,
+// in bucket order, and swaps it with the timed arena.
+static void compactTimedText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    Arena & timedText    = DD_CONTEXT->timedText;
+    Arena & scratchArena = DD_CONTEXT->scratchArena;
+
+    // The live text is never larger than what is in the timed arena now.
+    // If we can't get that much, just try again after the next flush.
+    scratchArena.used = 0;
+    if (!arenaReserve(scratchArena, *DD_CONTEXT->allocator, timedText.used))
+    {
+        return;
+    }
+
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        const DebugQueue & queue = DD_CONTEXT->debugStrings[priority];
+        for (int b = 0; b < queue.numBuckets; ++b)
+        {
+            for (QueueChunk * chunk = queue.buckets[b].head; chunk != nullptr; chunk = chunk->next)
+            {
+                DebugString * const debugStrings = DebugStringStreams(chunk, chunk->capacity).strings;
+                for (int i = 0; i < chunk->count; ++i)
+                {
+                    DebugString & dstr = debugStrings[i];
+                    dstr.textOffset = arenaAppend(scratchArena, timedText.data + dstr.textOffset, dstr.textLength);
+                }
+            }
+        }
+    }
+
+    const Arena temp = timedText;
+    timedText    = scratchArena;
+    scratchArena = temp;
+    DD_CONTEXT->timedTextLive = timedText.used;
+}
+
+// Expiry pass of the strings queue, which also reclaims the text of the removed strings.
+static void clearDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    int transientCount = 0;
+    int timedCount     = 0;
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        DebugQueue & queue = DD_CONTEXT->debugStrings[priority];
+        clearDebugQueue<DebugStringStreams>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) queue);
+        transientCount += queue.transient.count;
+        timedCount     += queue.count - queue.transient.count;
+    }
+
+    // Normally all the transient strings are gone now, so their text can go too.
+    if (transientCount == 0)
+    {
+        DD_CONTEXT->transientText.used = 0;
+    }
+
+    if (timedCount == 0)
+    {
+        DD_CONTEXT->timedText.used = 0;
+        DD_CONTEXT->timedTextLive  = 0;
+    }
+    else if (DD_CONTEXT->timedText.used > 2 * DD_CONTEXT->timedTextLive)
+    {
+        // Compacting only once the arena has doubled since the last time
+        // keeps the cost linear in the number of bytes ever appended.
+        compactTimedText(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    }
+}
+
+// Common code of screenText and projectedText. Copies the text into
+// the arena matching the string lifetime and queues the string.
+static void pushDebugString(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * const str, const float posX,
+                            const float posY, ddVec3_In color, const float scaling, const int durationMillis,
+                            const bool centered)
+{
+    const bool transient = (durationMillis <= 0);
+    Arena & arena = transient ? DD_CONTEXT->transientText : DD_CONTEXT->timedText;
+
+    int length = 0;
+    while (str[length] != '\0')
+    {
+        ++length;
+    }
+
+    if (!arenaReserve(arena, *DD_CONTEXT->allocator, length + 1))
+    {
+        DEBUG_DRAW_OVERFLOWED("Debug strings text arena allocation failed! Dropping further debug string draws.");
+        return;
+    }
+
+    QueueChunk * const chunk = queuePushEvicting<DebugStringStreams>(DD_CONTEXT->debugStrings, 1, 0,
+                                                                     DD_CONTEXT->drawPriority,
+                                                                     DD_CONTEXT->currentTimeMillis + durationMillis,
+                                                                     transient, DD_CONTEXT->evictionStats.evictedStrings);
+    if (chunk == nullptr)
+    {
+        ++DD_CONTEXT->evictionStats.droppedStrings;
+        DEBUG_DRAW_OVERFLOWED("Debug strings queue capacity reached! Dropping further debug string draws.");
+        return;
+    }
+
+    DebugString & dstr    = DebugStringStreams(chunk, chunk->capacity).strings[chunk->count - 1];
+    dstr.posX             = posX;
+    dstr.posY             = posY;
+    dstr.scaling          = scaling;
+    dstr.textOffset       = arenaAppend(arena, str, length);
+    dstr.textLength       = length;
+    dstr.centered         = centered;
+    vecCopy(dstr.color, color);
+}
+
+// Size in bytes of the geometry of a line mesh.
+static inline int lineMeshBytes(const int vertexCount, const int indexCount)
+{
+    return vertexCount * 3 * static_cast<int>(sizeof(float)) + indexCount * static_cast<int>(sizeof(std::uint16_t));
+}
+
+// Copies the geometry of the live timed meshes into the scratch arena,
+// in bucket order, and swaps it with the timed geometry arena.
+static void compactTimedGeometry(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    Arena & timedGeometry = DD_CONTEXT->timedGeometry;
+    Arena & scratchArena  = DD_CONTEXT->scratchArena;
+
+    // Same as for the text, the live geometry never takes more than what is in the
+    // timed arena now, alignment padding included, so a failure can just wait.
+    scratchArena.used = 0;
+    if (!arenaReserve(scratchArena, *DD_CONTEXT->allocator, timedGeometry.used))
+    {
+        return;
+    }
+
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            const DebugQueue & queue = DD_CONTEXT->debugMeshes[priority][depthEnabled];
+            for (int b = 0; b < queue.numBuckets; ++b)
+            {
+                for (QueueChunk * chunk = queue.buckets[b].head; chunk != nullptr; chunk = chunk->next)
+                {
+                    DebugLineMesh * const meshes = DebugMeshStreams(chunk, chunk->capacity).meshes;
+                    for (int i = 0; i < chunk->count; ++i)
+                    {
+                        DebugLineMesh & mesh = meshes[i];
+                        const int bytes  = lineMeshBytes(mesh.vertexCount, mesh.indexCount);
+                        const int offset = arenaAlloc(scratchArena, bytes);
+
+                        const char * const src = timedGeometry.data + mesh.geometryOffset;
+                        char * const dest = scratchArena.data + offset;
+                        for (int c = 0; c < bytes; ++c)
+                        {
+                            dest[c] = src[c];
+                        }
+                        mesh.geometryOffset = offset;
+                    }
+                }
+            }
+        }
+    }
+
+    const Arena temp = timedGeometry;
+    timedGeometry = scratchArena;
+    scratchArena  = temp;
+    DD_CONTEXT->timedGeometryLive = timedGeometry.used;
+}
+
+// Expiry pass of the line meshes queues, which also reclaims the geometry of the removed meshes.
+static void clearDebugMeshes(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    int transientCount = 0;
+    int timedCount     = 0;
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            DebugQueue & queue = DD_CONTEXT->debugMeshes[priority][depthEnabled];
+            clearDebugQueue<DebugMeshStreams>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) queue);
+            transientCount += queue.transient.count;
+            timedCount     += queue.count - queue.transient.count;
+        }
+    }
+
+    if (transientCount == 0)
+    {
+        DD_CONTEXT->transientGeometry.used = 0;
+    }
+
+    if (timedCount == 0)
+    {
+        DD_CONTEXT->timedGeometry.used = 0;
+        DD_CONTEXT->timedGeometryLive  = 0;
+    }
+    else if (DD_CONTEXT->timedGeometry.used > 2 * DD_CONTEXT->timedGeometryLive)
+    {
+        compactTimedGeometry(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    }
+}
+
+// Queues a line mesh with room for 'vertexCount' vertexes and 'indexCount' indexes,
+// for the shape functions to fill in. Returns the XYZ positions of the vertexes and
+// sets 'indexes' to the index list, or returns null if the mesh had to be dropped.
+static float * queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const int vertexCount, const int indexCount,
+                             const std::uint32_t color, const int durationMillis, const bool depthEnabled,
+                             std::uint16_t *& indexes)
+{
+    const bool transient = (durationMillis <= 0);
+    Arena & arena = transient ? DD_CONTEXT->transientGeometry : DD_CONTEXT->timedGeometry;
+    const int bytes = lineMeshBytes(vertexCount, indexCount);
+
+    if (!arenaReserve(arena, *DD_CONTEXT->allocator, arenaAllocBytes(bytes)))
+    {
+        DEBUG_DRAW_OVERFLOWED("Debug meshes geometry arena allocation failed! Dropping further debug shape draws.");
+        return nullptr;
+    }
+
+    QueueChunk * const chunk = queuePushEvicting<DebugMeshStreams>(&DD_CONTEXT->debugMeshes[0][0], 2, depthEnabled,
+                                                                   DD_CONTEXT->drawPriority,
+                                                                   DD_CONTEXT->currentTimeMillis + durationMillis,
+                                                                   transient, DD_CONTEXT->evictionStats.evictedMeshes);
+    if (chunk == nullptr)
+    {
+        ++DD_CONTEXT->evictionStats.droppedMeshes;
+        DEBUG_DRAW_OVERFLOWED("Debug meshes queue capacity reached! Dropping further debug shape draws.");
+        return nullptr;
+    }
+
+    DebugLineMesh & mesh = DebugMeshStreams(chunk, chunk->capacity).meshes[chunk->count - 1];
+    mesh.geometryOffset  = arenaAlloc(arena, bytes);
+    mesh.vertexCount     = vertexCount;
+    mesh.indexCount      = indexCount;
+    mesh.color           = color;
+
+    float * const positions = reinterpret_cast<float *>(arena.data + mesh.geometryOffset);
+    indexes = reinterpret_cast<std::uint16_t *>(positions + vertexCount * 3);
+    return positions;
+}
+
+static inline float * queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const int vertexCount, const int indexCount,
+                                    ddVec3_In color, const int durationMillis, const bool depthEnabled,
+                                    std::uint16_t *& indexes)
+{
+    return queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) vertexCount, indexCount, packColor(color),
+                         durationMillis, depthEnabled, indexes);
+}
+
+// Appends the line between vertexes 'a' and 'b' to the index list of a mesh.
+static inline void addMeshLine(std::uint16_t *& indexes, const int a, const int b)
+{
+    *indexes++ = static_cast<std::uint16_t>(a);
+    *indexes++ = static_cast<std::uint16_t>(b);
+}
+
+// Queues an instance of a registered unit shape mesh. Returns the
+// transform for the caller to fill in, or null if it had to be dropped.
+static float * queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const ShapeMesh shape, const std::uint32_t color,
+                                  const int durationMillis, const bool depthEnabled)
+{
+    const bool transient = (durationMillis <= 0);
+    QueueChunk * const chunk = queuePushEvicting<ShapeInstanceStreams>(&DD_CONTEXT->debugInstances[0][0][0], 2 * ShapeMeshCount,
+                                                                       (depthEnabled ? ShapeMeshCount : 0) + shape,
+                                                                       DD_CONTEXT->drawPriority,
+                                                                       DD_CONTEXT->currentTimeMillis + durationMillis,
+                                                                       transient, DD_CONTEXT->evictionStats.evictedMeshes);
+    if (chunk == nullptr)
+    {
+        ++DD_CONTEXT->evictionStats.droppedMeshes;
+        DEBUG_DRAW_OVERFLOWED("Debug shape instances queue capacity reached! Dropping further debug shape draws.");
+        return nullptr;
+    }
+
+    ShapeInstance & instance = ShapeInstanceStreams(chunk, chunk->capacity).instances[chunk->count - 1];
+    instance.color = color;
+    return instance.transform;
+}
+
+static inline float * queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const ShapeMesh shape, ddVec3_In color,
+                                         const int durationMillis, const bool depthEnabled)
+{
+    return queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ctx,) shape, packColor(color), durationMillis, depthEnabled);
+}
+
+// Fills in a ShapeInstance transform from the images of the unit axes and origin.
+static void setInstanceTransform(float transform[12], ddVec3_In xAxis, ddVec3_In yAxis,
+                                 ddVec3_In zAxis, ddVec3_In origin)
+{
+    for (int row = 0; row < 3; ++row)
+    {
+        transform[row * 4 + 0] = xAxis[row];
+        transform[row * 4 + 1] = yAxis[row];
+        transform[row * 4 + 2] = zAxis[row];
+        transform[row * 4 + 3] = origin[row];
+    }
+}
+
+//
+// Level of detail of the round shapes, see dd::setLodTolerance().
+//
+
+// Fewer segments than this are never used for a full circle.
+static const int LodMinSteps = 4;
+
+// Number of segments a full circle of 'radius' around 'center' needs for the gap
+// between each segment and its arc to stay under the tolerance on screen. False if
+// the level of detail is off or the camera can't tell, for full detail.
+static bool lodMinSteps(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center,
+                        const float radius, float & minSteps)
+{
+    if (DD_CONTEXT->lodTolerance <= 0.0f || DD_CONTEXT->lodPixelSize <= 0.0f || radius <= 0.0f)
+    {
+        return false;
+    }
+
+    const float * const m = DD_CONTEXT->viewProjMatrix;
+    const float clipW = (m[3] * center[X]) + (m[7] * center[Y]) + (m[11] * center[Z]) + m[15];
+    if (clipW <= 0.0f)
+    {
+        return false;
+    }
+
+    // A segment spanning 'a' radians is at most radius * a^2 / 8 away from its arc,
+    // so N segments are close enough when N >= PI * sqrt(radius / (2 * tolerance)).
+    const float tolerance = DD_CONTEXT->lodTolerance * DD_CONTEXT->lodPixelSize * clipW;
+    const float ratio     = radius / (2.0f * tolerance);
+    minSteps = PI * ratio * floatInvSqrt(ratio);
+    return true;
+}
+
+// Largest stride, up to 'maxStride', to walk a unit circle table of 'numSteps'
+// steps with that still gives the circle enough segments. 1 for full detail.
+static int lodStride(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, const float radius,
+                     const int numSteps, const int maxStride)
+{
+    float minSteps;
+    if (!lodMinSteps(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, radius, minSteps))
+    {
+        return 1;
+    }
+
+    for (int stride = maxStride; stride > 1; --stride)
+    {
+        const int steps = numSteps / stride;
+        if ((numSteps % stride) == 0 && steps >= LodMinSteps && steps >= minSteps)
+        {
+            return stride;
+        }
+    }
+    return 1;
+}
+
+static void countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const int fullLines, const int lines)
+{
+    if (lines < fullLines)
+    {
+        DD_CONTEXT->lodStats.linesSaved += fullLines - lines;
+        ++DD_CONTEXT->lodStats.reducedShapes;
+    }
+}
+
+//
+// Line mesh generators shared by the shape functions and the unit meshes
+// registered with RenderInterface::createShapeMesh(). The 'stride' is the
+// step through the unit circle tables, above 1 for a coarser level of detail.
+//
+
+static const int SphereStepSize     = 15;
+static const int SphereNumSteps     = 360 / SphereStepSize;   // Segments around each ring.
+static const int SphereNumRings     = SphereNumSteps / 2 - 1; // Rings between the poles.
+static const int SphereMeshVerts    = 2 + SphereNumRings * SphereNumSteps;
+static const int SphereMeshIndexes  = SphereNumSteps * (SphereNumRings * 2 + 1) * 2;
+static const int SphereMaxRings     = 63;
+static const int SphereMaxSegments  = 128;
+
+static const int ConeStepSize       = 20;
+static const int ConeNumSteps       = 360 / ConeStepSize;
+static const int ConeMeshVerts      = 2 + ConeNumSteps;
+static const int ConeMeshIndexes    = ConeNumSteps * 4;
+
+static const int BoxMeshVerts       = 8;
+static const int BoxMeshIndexes     = 24;
+
+// Each ring has one line per segment, and each of the 'numSegments' meridians
+// one line per ring plus one more to reach the far pole.
+static inline int sphereMeshVerts(const int numRings, const int numSegments)   { return 2 + numRings * numSegments; }
+static inline int sphereMeshIndexes(const int numRings, const int numSegments) { return numSegments * (numRings * 2 + 1) * 2; }
+
+// Fills the (sin, cos) pairs of angles 0, step, ..., count * step, with
+// count * step = 'totalDegrees'. Steps that are a multiple of the sphere
+// step come straight from its table, any other rotates the previous pair.
+static void sphereAngles(float * const sines, float * const cosines, const int count, const int totalDegrees)
+{
+    if ((totalDegrees % (count * SphereStepSize)) == 0)
+    {
+        const SinCosTable<SphereStepSize> & table = sinCosTable<SphereStepSize>();
+        const int stride = totalDegrees / (count * SphereStepSize);
+        for (int i = 0; i <= count; ++i)
+        {
+            sines[i]   = table.sin[i * stride];
+            cosines[i] = table.cos[i * stride];
         }
+        return;
+    }
+
+    const float step    = degreesToRadians(static_cast<float>(totalDegrees)) / count;
+    const float stepSin = floatSin(step);
+    const float stepCos = floatCos(step);
+    sines[0]   = 0.0f;
+    cosines[0] = 1.0f;
+    for (int i = 1; i <= count; ++i)
+    {
+        sines[i]   = sines[i - 1] * stepCos + cosines[i - 1] * stepSin;
+        cosines[i] = cosines[i - 1] * stepCos - sines[i - 1] * stepSin;
     }
-
-    flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeText, false);
 }
 
-static void drawDebugPoints(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+// Vertex 0 is the +Z pole, followed by the rings, from the +Z pole down,
+// then the -Z pole. Every edge of the grid is emitted exactly once: each
+// ring vertex has a line to the next one along its ring and one up its
+// meridian, and the last ring also has one down to the -Z pole.
+static void writeSphereMesh(float * const positions, std::uint16_t * indexes, ddVec3_In center,
+                            const float radius, const int numRings, const int numSegments)
 {
-    const int count = DD_CONTEXT->debugPointsCount;
-    if (count == 0)
-    {
-        return;
-    }
+    float ringSines[SphereMaxRings + 2],       ringCosines[SphereMaxRings + 2];
+    float segmentSines[SphereMaxSegments + 1], segmentCosines[SphereMaxSegments + 1];
+    sphereAngles(ringSines, ringCosines, numRings + 1, 180);
+    sphereAngles(segmentSines, segmentCosines, numSegments, 360);
 
-    const DebugPoint * const debugPoints = DD_CONTEXT->debugPoints;
+    const int lastVertex = numRings * numSegments + 1;
+    vecSet(positions, center[X], center[Y], center[Z] + radius);
+    vecSet(&positions[lastVertex * 3], center[X], center[Y], center[Z] - radius);
 
-    //
-    // First pass, points with depth test ENABLED:
-    //
-    int numDepthlessPoints = 0;
-    for (int i = 0; i < count; ++i)
+    int ring = 1;
+    for (int i = 1; i <= numRings; ++i, ring += numSegments)
     {
-        const DebugPoint & point = debugPoints[i];
-        if (point.depthEnabled)
+        const float ringRadius = radius * ringSines[i];
+
+        ddVec3 ringCenter, sinAxis, cosAxis;
+        vecSet(ringCenter, center[X], center[Y], center[Z] + radius * ringCosines[i]);
+        vecSet(sinAxis, ringRadius, 0.0f, 0.0f);
+        vecSet(cosAxis, 0.0f, ringRadius, 0.0f);
+        ringPoints(&positions[ring * 3], ringCenter, sinAxis, cosAxis, segmentSines, segmentCosines, 1, numSegments);
+
+        for (int n = 0; n < numSegments; ++n)
         {
-            pushPointVert(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point);
+            addMeshLine(indexes, ring + n, ring + ((n + 1) % numSegments));
+            addMeshLine(indexes, ring + n, (i == 1) ? 0 : (ring - numSegments + n));
         }
-        numDepthlessPoints += !point.depthEnabled;
     }
-    flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModePoints, true);
 
-    //
-    // Second pass draws points with depth DISABLED:
-    //
-    if (numDepthlessPoints > 0)
+    for (int n = 0; n < numSegments; ++n)
     {
-        for (int i = 0; i < count; ++i)
-        {
-            const DebugPoint & point = debugPoints[i];
-            if (!point.depthEnabled)
-            {
-                pushPointVert(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point);
-            }
-        }
-        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModePoints, false);
+        addMeshLine(indexes, ring - numSegments + n, lastVertex);
     }
 }
 
-static void drawDebugLines(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+// Vertex 0 is the apex, followed by the base circle around 'top'.
+static void writeConeMesh(float * const positions, std::uint16_t * indexes, ddVec3_In apex, ddVec3_In top,
+                          const ddVec3 axis[2], const float baseRadius, const int stride = 1)
 {
-    const int count = DD_CONTEXT->debugLinesCount;
-    if (count == 0)
+    const SinCosTable<ConeStepSize> & table = sinCosTable<ConeStepSize>();
+    const int numSteps = ConeNumSteps / stride;
+
+    ddVec3 sinAxis, cosAxis;
+    vecScale(sinAxis, axis[0], baseRadius);
+    vecScale(cosAxis, axis[1], baseRadius);
+
+    vecCopy(positions, apex);
+    ringPoints(&positions[3], top, sinAxis, cosAxis, table.sin, table.cos, stride, numSteps + 1);
+
+    for (int n = 1; n <= numSteps; ++n)
     {
-        return;
+        addMeshLine(indexes, n, n + 1);
+        addMeshLine(indexes, n + 1, 0);
     }
+}
 
-    const DebugLine * const debugLines = DD_CONTEXT->debugLines;
-
-    //
-    // First pass, lines with depth test ENABLED:
-    //
-    int numDepthlessLines = 0;
-    for (int i = 0; i < count; ++i)
+static void writeBoxMesh(float * const positions, std::uint16_t * indexes, const ddVec3 points[8])
+{
+    for (int i = 0; i < 8; ++i)
     {
-        const DebugLine & line = debugLines[i];
-        if (line.depthEnabled)
-        {
-            pushLineVert(DD_EXPLICIT_CONTEXT_ONLY(ctx,) line);
-        }
-        numDepthlessLines += !line.depthEnabled;
+        vecCopy(&positions[i * 3], points[i]);
     }
-    flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, true);
 
-    //
-    // Second pass draws lines with depth DISABLED:
-    //
-    if (numDepthlessLines > 0)
+    // Build the lines from points using clever indexing tricks:
+    // (& 3 is a fancy way of doing % 4, but avoids the expensive modulo operation)
+    for (int i = 0; i < 4; ++i)
     {
-        for (int i = 0; i < count; ++i)
-        {
-            const DebugLine & line = debugLines[i];
-            if (!line.depthEnabled)
-            {
-                pushLineVert(DD_EXPLICIT_CONTEXT_ONLY(ctx,) line);
-            }
-        }
-        flushDebugVerts(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DrawModeLines, false);
+        addMeshLine(indexes, i, (i + 1) & 3);
+        addMeshLine(indexes, 4 + i, 4 + ((i + 1) & 3));
+        addMeshLine(indexes, i, 4 + i);
     }
 }
 
-template<typename T>
-static void clearDebugQueue(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) T * queue, int & queueCount)
+// The eight corners of a box, in the order writeBoxMesh() expects.
+static void boxCorners(ddVec3 points[8], ddVec3_In center, const float width, const float height, const float depth)
 {
-    const std::int64_t time = DD_CONTEXT->currentTimeMillis;
-    if (time == 0)
+    const float cx = center[X];
+    const float cy = center[Y];
+    const float cz = center[Z];
+    const float w  = width  * 0.5f;
+    const float h  = height * 0.5f;
+    const float d  = depth  * 0.5f;
+
+    #define DD_BOX_V(v, op1, op2, op3) \
+    v[X] = cx op1 w; \
+    v[Y] = cy op2 h; \
+    v[Z] = cz op3 d
+    DD_BOX_V(points[0], -, +, +);
+    DD_BOX_V(points[1], -, +, -);
+    DD_BOX_V(points[2], +, +, -);
+    DD_BOX_V(points[3], +, +, +);
+    DD_BOX_V(points[4], -, -, +);
+    DD_BOX_V(points[5], -, -, -);
+    DD_BOX_V(points[6], +, -, -);
+    DD_BOX_V(points[7], +, -, +);
+    #undef DD_BOX_V
+}
+
+// Offers the unit shape meshes to the renderer. The ones it
+// takes get their shapes queued as instances from then on.
+static void setupShapeMeshes(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (DD_CONTEXT->renderInterface == nullptr)
     {
-        queueCount = 0;
         return;
     }
 
-    int index = 0;
-    T * pElem = queue;
+    // Big enough for the largest of the meshes, the sphere.
+    Allocator & allocator = *DD_CONTEXT->allocator;
+    const int bytes = lineMeshBytes(SphereMeshVerts, SphereMeshIndexes);
+    float * const positions = static_cast<float *>(allocator.allocate(bytes, alignof(float)));
+    if (positions == nullptr)
+    {
+        return; // Shapes are drawn as line meshes then.
+    }
+
+    const ddVec3 origin = { 0.0f, 0.0f, 0.0f };
+    const ddVec3 unitZ  = { 0.0f, 0.0f, 1.0f };
+    const ddVec3 unitXY[2] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+    ddVec3 corners[8];
+    boxCorners(corners, origin, 1.0f, 1.0f, 1.0f);
 
-    // Concatenate elements that still need to be draw on future frames:
-    for (int i = 0; i < queueCount; ++i, ++pElem)
+    for (int shape = 0; shape < ShapeMeshCount; ++shape)
     {
-        if (pElem->expiryDateMillis > time)
+        int vertexCount, indexCount;
+        switch (shape)
         {
-            if (index != i)
-            {
-                queue[index] = *pElem;
-            }
-            ++index;
-        }
+        case ShapeMeshSphere :
+            vertexCount = SphereMeshVerts;
+            indexCount  = SphereMeshIndexes;
+            writeSphereMesh(positions, reinterpret_cast<std::uint16_t *>(positions + vertexCount * 3), origin, 1.0f,
+                            SphereNumRings, SphereNumSteps);
+            break;
+        case ShapeMeshBox :
+            vertexCount = BoxMeshVerts;
+            indexCount  = BoxMeshIndexes;
+            writeBoxMesh(positions, reinterpret_cast<std::uint16_t *>(positions + vertexCount * 3), corners);
+            break;
+        default :
+            vertexCount = ConeMeshVerts;
+            indexCount  = ConeMeshIndexes;
+            writeConeMesh(positions, reinterpret_cast<std::uint16_t *>(positions + vertexCount * 3), origin, unitZ, unitXY, 1.0f);
+            break;
+        } // switch (shape)
+
+        DD_CONTEXT->shapeMeshes[shape] = DD_CONTEXT->renderInterface->createShapeMesh(
+                                                static_cast<ShapeMesh>(shape), positions, vertexCount,
+                                                reinterpret_cast<const std::uint16_t *>(positions + vertexCount * 3),
+                                                indexCount);
     }
 
-    queueCount = index;
+    allocator.deallocate(positions, bytes);
 }
 
 static void setupGlyphTexture(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
@@ -2509,7 +6168,8 @@ static void setupGlyphTexture(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
         DD_CONTEXT->glyphTexHandle = nullptr;
     }
 
-    std::uint8_t * decompressedBitmap = decompressFontBitmap();
+    Allocator & allocator = *DD_CONTEXT->allocator;
+    std::uint8_t * decompressedBitmap = decompressFontBitmap(allocator);
     if (decompressedBitmap == nullptr)
     {
         return; // Failed to decompressed. No font rendering available.
@@ -2521,27 +6181,154 @@ static void setupGlyphTexture(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
                                         decompressedBitmap);
 
     // No longer needed.
-    DD_MFREE(decompressedBitmap);
+    allocator.deallocate(decompressedBitmap, getFontCharSet().bitmapDecompressSize);
 }
 
 // ========================================================
 // Public Debug Draw interface:
 // ========================================================
 
-bool initialize(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle * outCtx,) RenderInterface * renderer)
+// Used by contexts created without a dd::ContextDesc::allocator.
+static Allocator s_defaultAllocator;
+
+static void destroyContext(InternalContext * context)
+{
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        queueRelease(context->debugStrings[priority]);
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            releaseQueueRanges(context->renderInterface, context->debugLines[priority][depthEnabled]);
+            queueRelease(context->debugPoints[priority][depthEnabled]);
+            queueRelease(context->debugLines[priority][depthEnabled]);
+            queueRelease(context->debugMeshes[priority][depthEnabled]);
+            for (int shape = 0; shape < ShapeMeshCount; ++shape)
+            {
+                queueRelease(context->debugInstances[priority][depthEnabled][shape]);
+            }
+        }
+    }
+
+    poolRelease<DebugStringStreams>(context->stringsPool);
+    poolRelease<DebugPointStreams>(context->pointsPool);
+    poolRelease<DebugLineStreams>(context->linesPool);
+    poolRelease<DebugMeshStreams>(context->meshesPool);
+    poolRelease<ShapeInstanceStreams>(context->instancesPool);
+
+    Allocator & allocator = *context->allocator;
+    arenaRelease(context->transientText,     allocator);
+    arenaRelease(context->timedText,         allocator);
+    arenaRelease(context->transientGeometry, allocator);
+    arenaRelease(context->timedGeometry,     allocator);
+    arenaRelease(context->scratchArena,      allocator);
+
+    for (int i = 0; i < MaxStagingBuffers; ++i)
+    {
+        if (context->vertexBuffers[i] != nullptr)
+        {
+            if (context->vertexBufferPending[i])
+            {
+                context->renderInterface->waitBufferConsumed(context->vertexBuffers[i]);
+            }
+            allocator.deallocate(context->vertexBuffers[i], context->vertexBufferSizes[i] * VertexBufferStride);
+        }
+    }
+    releaseMeshBuffers(context);
+    releaseGlyphBuffers(context);
+
+    context->~InternalContext(); // Destroy first
+    allocator.deallocate(context, sizeof(InternalContext));
+}
+
+ContextDesc::ContextDesc()
+{
+    lines.initialCapacity   = DEBUG_DRAW_QUEUE_CHUNK_SIZE;
+    lines.chunkCapacity     = DEBUG_DRAW_QUEUE_CHUNK_SIZE;
+    lines.maxCapacity       = DEBUG_DRAW_MAX_LINES;
+
+    points.initialCapacity  = DEBUG_DRAW_QUEUE_CHUNK_SIZE;
+    points.chunkCapacity    = DEBUG_DRAW_QUEUE_CHUNK_SIZE;
+    points.maxCapacity      = DEBUG_DRAW_MAX_POINTS;
+
+    // Strings are a lot fewer and bulkier, so we grow those in smaller steps.
+    strings.initialCapacity = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    strings.chunkCapacity   = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    strings.maxCapacity     = DEBUG_DRAW_MAX_STRINGS;
+
+    // So are meshes, each standing for up to a thousand lines.
+    meshes.initialCapacity  = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    meshes.chunkCapacity    = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    meshes.maxCapacity      = DEBUG_DRAW_MAX_MESHES;
+
+    shapeInstances.initialCapacity = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    shapeInstances.chunkCapacity   = DEBUG_DRAW_QUEUE_CHUNK_SIZE / 16;
+    shapeInstances.maxCapacity     = DEBUG_DRAW_MAX_SHAPE_INSTANCES;
+
+    expiryBucketMillis      = DEBUG_DRAW_EXPIRY_BUCKET_MILLIS;
+    vertexFormat            = VertexFormatDefault;
+    textArenaBytes          = DEBUG_DRAW_TEXT_ARENA_SIZE;
+    allocator               = nullptr;
+    pointQuads              = false;
+    stagingBuffers          = 1;
+    singleShot              = false;
+}
+
+bool initialize(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle * outCtx,) RenderInterface * renderer, const ContextDesc * desc)
 {
     if (renderer == nullptr)
     {
         return false;
     }
 
-    void * buffer = DD_MALLOC(sizeof(InternalContext));
+    const ContextDesc defaultDesc;
+    if (desc == nullptr)
+    {
+        desc = &defaultDesc;
+    }
+
+    Allocator & allocator = (desc->allocator != nullptr) ? *desc->allocator : s_defaultAllocator;
+    void * buffer = allocator.allocate(sizeof(InternalContext), alignof(InternalContext));
     if (buffer == nullptr)
     {
         return false;
     }
 
-    InternalContext * newCtx = ::new(buffer) InternalContext(renderer);
+    InternalContext * newCtx = ::new(buffer) InternalContext(renderer, allocator);
+    newCtx->vertexFormat   = desc->vertexFormat;
+    newCtx->textArenaBytes = (desc->textArenaBytes > 0) ? desc->textArenaBytes : 0;
+    newCtx->pointQuads     = desc->pointQuads;
+    newCtx->singleShot     = desc->singleShot;
+
+    newCtx->numVertexBuffers = desc->stagingBuffers;
+    if (newCtx->numVertexBuffers < 1)                 { newCtx->numVertexBuffers = 1; }
+    if (newCtx->numVertexBuffers > MaxStagingBuffers) { newCtx->numVertexBuffers = MaxStagingBuffers; }
+
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        queueInit(newCtx->debugStrings[priority], newCtx->stringsPool, desc->expiryBucketMillis);
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            queueInit(newCtx->debugPoints[priority][depthEnabled], newCtx->pointsPool, desc->expiryBucketMillis);
+            queueInit(newCtx->debugLines[priority][depthEnabled],  newCtx->linesPool,  desc->expiryBucketMillis);
+            queueInit(newCtx->debugMeshes[priority][depthEnabled], newCtx->meshesPool, desc->expiryBucketMillis);
+            for (int shape = 0; shape < ShapeMeshCount; ++shape)
+            {
+                queueInit(newCtx->debugInstances[priority][depthEnabled][shape], newCtx->instancesPool, desc->expiryBucketMillis);
+            }
+        }
+    }
+
+    if (!poolInit<DebugStringStreams>(newCtx->stringsPool, allocator, desc->strings) ||
+        !poolInit<DebugPointStreams>(newCtx->pointsPool,   allocator, desc->points)  ||
+        !poolInit<DebugLineStreams>(newCtx->linesPool,     allocator, desc->lines)   ||
+        !poolInit<DebugMeshStreams>(newCtx->meshesPool,    allocator, desc->meshes)  ||
+        !poolInit<ShapeInstanceStreams>(newCtx->instancesPool, allocator, desc->shapeInstances) ||
+        (desc->textArenaBytes > 0 && !arenaReserve(newCtx->transientText, allocator, desc->textArenaBytes)) ||
+        (desc->textArenaBytes > 0 && !arenaReserve(newCtx->timedText,     allocator, desc->textArenaBytes)))
+    {
+        destroyContext(newCtx);
+        return false;
+    }
 
     #ifdef DEBUG_DRAW_EXPLICIT_CONTEXT
     if ((*outCtx) != nullptr) { shutdown(*outCtx); }
@@ -2552,6 +6339,7 @@ bool initialize(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle * outCtx,) RenderInterfac
     #endif // DEBUG_DRAW_EXPLICIT_CONTEXT
 
     setupGlyphTexture(DD_EXPLICIT_CONTEXT_ONLY(*outCtx));
+    setupShapeMeshes(DD_EXPLICIT_CONTEXT_ONLY(*outCtx));
     return true;
 }
 
@@ -2559,28 +6347,19 @@ void shutdown(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
 {
     if (DD_CONTEXT != nullptr)
     {
-        // If this macro is defined, the user-provided ddStr type
-        // needs some extra cleanup before shutdown, so we run for
-        // all entries in the debugStrings[] array.
-        //
-        // We could call std::string::clear() here, but clear()
-        // doesn't deallocate memory in std string, so we might
-        // as well let the default destructor do the cleanup,
-        // when using the default (AKA std::string) ddStr.
-        #ifdef DEBUG_DRAW_STR_DEALLOC_FUNC
-        for (int i = 0; i < DEBUG_DRAW_MAX_STRINGS; ++i)
-        {
-            DEBUG_DRAW_STR_DEALLOC_FUNC(DD_CONTEXT->debugStrings[i].text);
-        }
-        #endif // DEBUG_DRAW_STR_DEALLOC_FUNC
-
         if (DD_CONTEXT->renderInterface != nullptr && DD_CONTEXT->glyphTexHandle != nullptr)
         {
             DD_CONTEXT->renderInterface->destroyGlyphTexture(DD_CONTEXT->glyphTexHandle);
         }
+        for (int shape = 0; shape < ShapeMeshCount; ++shape)
+        {
+            if (DD_CONTEXT->renderInterface != nullptr && DD_CONTEXT->shapeMeshes[shape] != nullptr)
+            {
+                DD_CONTEXT->renderInterface->destroyShapeMesh(DD_CONTEXT->shapeMeshes[shape]);
+            }
+        }
 
-        DD_CONTEXT->~InternalContext(); // Destroy first
-        DD_MFREE(DD_CONTEXT);
+        destroyContext(DD_CONTEXT);
 
         #ifndef DEBUG_DRAW_EXPLICIT_CONTEXT
         DD_CONTEXT = nullptr;
@@ -2588,112 +6367,422 @@ void shutdown(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
     }
 }
 
-bool isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+bool isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    return (DD_CONTEXT != nullptr && DD_CONTEXT->renderInterface != nullptr);
+}
+
+bool hasPendingDraws(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return false;
+    }
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        if ((DD_CONTEXT->debugStrings[priority].count +
+             DD_CONTEXT->debugPoints[priority][0].count + DD_CONTEXT->debugPoints[priority][1].count +
+             DD_CONTEXT->debugLines[priority][0].count  + DD_CONTEXT->debugLines[priority][1].count +
+             DD_CONTEXT->debugMeshes[priority][0].count + DD_CONTEXT->debugMeshes[priority][1].count) > 0)
+        {
+            return true;
+        }
+        for (int shape = 0; shape < ShapeMeshCount; ++shape)
+        {
+            if ((DD_CONTEXT->debugInstances[priority][0][shape].count +
+                 DD_CONTEXT->debugInstances[priority][1][shape].count) > 0)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void flush(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const std::int64_t currTimeMillis, const std::uint32_t flags)
+{
+    if (!hasPendingDraws(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    // Save the last know time value for next dd::line/dd::point calls.
+    DD_CONTEXT->currentTimeMillis = currTimeMillis;
+
+    // Let the user set common render states.
+    DD_CONTEXT->renderInterface->beginDraw();
+
+    // Issue the render calls:
+    if (flags & FlushLines)  { drawDebugLines(DD_EXPLICIT_CONTEXT_ONLY(ctx));   }
+    if (flags & FlushPoints) { drawDebugPoints(DD_EXPLICIT_CONTEXT_ONLY(ctx));  }
+    if (flags & FlushText)   { drawDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ctx)); }
+
+    // And cleanup if needed.
+    DD_CONTEXT->renderInterface->endDraw();
+
+    // Remove all expired objects, regardless of draw flags:
+    clearDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    clearDebugMeshes(DD_EXPLICIT_CONTEXT_ONLY(ctx));
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            clearDebugQueue<DebugPointStreams>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugPoints[priority][depthEnabled]);
+            clearDebugQueue<DebugLineStreams>(DD_EXPLICIT_CONTEXT_ONLY(ctx,)  DD_CONTEXT->debugLines[priority][depthEnabled]);
+            for (int shape = 0; shape < ShapeMeshCount; ++shape)
+            {
+                clearDebugQueue<ShapeInstanceStreams>(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugInstances[priority][depthEnabled][shape]);
+            }
+        }
+    }
+}
+
+void clear(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    DD_CONTEXT->vertexBufferUsed       = 0;
+    DD_CONTEXT->transientText.used     = 0;
+    DD_CONTEXT->timedText.used         = 0;
+    DD_CONTEXT->timedTextLive          = 0;
+    DD_CONTEXT->transientGeometry.used = 0;
+    DD_CONTEXT->timedGeometry.used     = 0;
+    DD_CONTEXT->timedGeometryLive      = 0;
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        queueReset(DD_CONTEXT->debugStrings[priority]);
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            releaseQueueRanges(DD_CONTEXT->renderInterface, DD_CONTEXT->debugLines[priority][depthEnabled]);
+            queueReset(DD_CONTEXT->debugPoints[priority][depthEnabled]);
+            queueReset(DD_CONTEXT->debugLines[priority][depthEnabled]);
+            queueReset(DD_CONTEXT->debugMeshes[priority][depthEnabled]);
+            for (int shape = 0; shape < ShapeMeshCount; ++shape)
+            {
+                queueReset(DD_CONTEXT->debugInstances[priority][depthEnabled][shape]);
+            }
+        }
+    }
+}
+
+void trim(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    poolTrim<DebugStringStreams>(DD_CONTEXT->stringsPool);
+    poolTrim<DebugPointStreams>(DD_CONTEXT->pointsPool);
+    poolTrim<DebugLineStreams>(DD_CONTEXT->linesPool);
+    poolTrim<DebugMeshStreams>(DD_CONTEXT->meshesPool);
+    poolTrim<ShapeInstanceStreams>(DD_CONTEXT->instancesPool);
+
+    Allocator & allocator = *DD_CONTEXT->allocator;
+    arenaTrim(DD_CONTEXT->transientText,     allocator, DD_CONTEXT->textArenaBytes);
+    arenaTrim(DD_CONTEXT->timedText,         allocator, DD_CONTEXT->textArenaBytes);
+    arenaTrim(DD_CONTEXT->transientGeometry, allocator, 0);
+    arenaTrim(DD_CONTEXT->timedGeometry,     allocator, 0);
+    arenaRelease(DD_CONTEXT->scratchArena, allocator);
+
+    // Vertex buffers grown in single-shot mode get allocated again at the default size.
+    for (int i = 0; i < MaxStagingBuffers; ++i)
+    {
+        if (DD_CONTEXT->vertexBufferSizes[i] > DEBUG_DRAW_VERTEX_BUFFER_SIZE)
+        {
+            if (DD_CONTEXT->vertexBufferPending[i])
+            {
+                DD_CONTEXT->renderInterface->waitBufferConsumed(DD_CONTEXT->vertexBuffers[i]);
+                DD_CONTEXT->vertexBufferPending[i] = false;
+            }
+            allocator.deallocate(DD_CONTEXT->vertexBuffers[i], DD_CONTEXT->vertexBufferSizes[i] * VertexBufferStride);
+            DD_CONTEXT->vertexBuffers[i]     = nullptr;
+            DD_CONTEXT->vertexBufferSizes[i] = 0;
+        }
+    }
+
+    // Bucket arrays get allocated again on the next timed draw.
+    for (int priority = 0; priority < DrawPriorityCount; ++priority)
+    {
+        queueTrim(DD_CONTEXT->debugStrings[priority]);
+        for (int depthEnabled = 0; depthEnabled < 2; ++depthEnabled)
+        {
+            queueTrim(DD_CONTEXT->debugPoints[priority][depthEnabled]);
+            queueTrim(DD_CONTEXT->debugLines[priority][depthEnabled]);
+            queueTrim(DD_CONTEXT->debugMeshes[priority][depthEnabled]);
+            for (int shape = 0; shape < ShapeMeshCount; ++shape)
+            {
+                queueTrim(DD_CONTEXT->debugInstances[priority][depthEnabled][shape]);
+            }
+        }
+    }
+}
+
+void setDrawPriority(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const DrawPriority priority)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    if (priority >= DrawPriorityLow && priority < DrawPriorityCount)
+    {
+        DD_CONTEXT->drawPriority = priority;
+    }
+}
+
+void setCamera(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddMat4x4_In viewProjMatrix,
+               const int viewportWidth, const int viewportHeight)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        DD_CONTEXT->viewProjMatrix[i] = viewProjMatrix[i];
+    }
+    DD_CONTEXT->viewportWidth  = viewportWidth;
+    DD_CONTEXT->viewportHeight = viewportHeight;
+    DD_CONTEXT->hasCamera      = true;
+
+    // The level of detail measures errors with the smaller of the pixel sides.
+    PointQuadAxes axes;
+    DD_CONTEXT->lodPixelSize = 0.0f;
+    if (computePointQuadAxes(DD_EXPLICIT_CONTEXT_ONLY(ctx,) axes))
+    {
+        const float rightSqr = (axes.right[X] * axes.right[X]) + (axes.right[Y] * axes.right[Y]) + (axes.right[Z] * axes.right[Z]);
+        const float upSqr    = (axes.up[X] * axes.up[X]) + (axes.up[Y] * axes.up[Y]) + (axes.up[Z] * axes.up[Z]);
+        const float minSqr   = (rightSqr < upSqr) ? rightSqr : upSqr;
+        if (minSqr > 0.0f)
+        {
+            DD_CONTEXT->lodPixelSize = minSqr * floatInvSqrt(minSqr);
+        }
+    }
+}
+
+void setLodTolerance(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float maxErrorPixels)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+    DD_CONTEXT->lodTolerance = (maxErrorPixels > 0.0f) ? maxErrorPixels : 0.0f;
+}
+
+DrawPriority getDrawPriority(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return DrawPriorityNormal;
+    }
+    return DD_CONTEXT->drawPriority;
+}
+
+void getEvictionStats(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) EvictionStats * stats)
+{
+    if (stats == nullptr)
+    {
+        return;
+    }
+
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        *stats = EvictionStats();
+        return;
+    }
+    *stats = DD_CONTEXT->evictionStats;
+}
+
+void getLodStats(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) LodStats * stats)
 {
-    return (DD_CONTEXT != nullptr && DD_CONTEXT->renderInterface != nullptr);
+    if (stats == nullptr)
+    {
+        return;
+    }
+
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        *stats = LodStats();
+        return;
+    }
+    *stats = DD_CONTEXT->lodStats;
 }
 
-bool hasPendingDraws(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+void point(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In pos, ddVec3_In color,
+           const float size, const int durationMillis, const bool depthEnabled)
 {
     if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
     {
-        return false;
+        return;
+    }
+
+    QueueChunk * const chunk = queuePushEvicting<DebugPointStreams>(&DD_CONTEXT->debugPoints[0][0], 2, depthEnabled,
+                                                                    DD_CONTEXT->drawPriority,
+                                                                    DD_CONTEXT->currentTimeMillis + durationMillis,
+                                                                    durationMillis <= 0, DD_CONTEXT->evictionStats.evictedPoints);
+    if (chunk == nullptr)
+    {
+        ++DD_CONTEXT->evictionStats.droppedPoints;
+        DEBUG_DRAW_OVERFLOWED("Debug points queue capacity reached! Dropping further debug point draws.");
+        return;
     }
-    return (DD_CONTEXT->debugStringsCount + DD_CONTEXT->debugPointsCount + DD_CONTEXT->debugLinesCount) > 0;
+
+    const DebugPointStreams points(chunk, chunk->capacity);
+    const int i = chunk->count - 1;
+
+    points.sizes[i]  = size;
+    points.colors[i] = packColor(color);
+
+    float * const p = &points.positions[i * 3];
+    p[0] = pos[X]; p[1] = pos[Y]; p[2] = pos[Z];
 }
 
-void flush(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const std::int64_t currTimeMillis, const std::uint32_t flags)
+int points(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * const positions, const int stride,
+           const int count, const float * const colors, const int colorStride, const float size,
+           const int durationMillis, const bool depthEnabled)
 {
-    if (!hasPendingDraws(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)) || positions == nullptr || colors == nullptr || count <= 0)
     {
-        return;
+        return 0;
     }
 
-    // Save the last know time value for next dd::line/dd::point calls.
-    DD_CONTEXT->currentTimeMillis = currTimeMillis;
+    const std::int64_t  expiry      = DD_CONTEXT->currentTimeMillis + durationMillis;
+    const bool          transient   = (durationMillis <= 0);
+    const std::uint32_t sharedColor = packStridedColor(colors, 0, 0);
+    DebugQueue & queue = DD_CONTEXT->debugPoints[DD_CONTEXT->drawPriority][depthEnabled];
 
-    // Let the user set common render states.
-    DD_CONTEXT->renderInterface->beginDraw();
+    // One push per chunk, which takes care of the eviction, then fill the rest of the chunk.
+    int accepted = 0;
+    while (accepted < count)
+    {
+        QueueChunk * const chunk = queuePushEvicting<DebugPointStreams>(&DD_CONTEXT->debugPoints[0][0], 2, depthEnabled,
+                                                                        DD_CONTEXT->drawPriority, expiry, transient,
+                                                                        DD_CONTEXT->evictionStats.evictedPoints);
+        if (chunk == nullptr)
+        {
+            DD_CONTEXT->evictionStats.droppedPoints += count - accepted;
+            DEBUG_DRAW_OVERFLOWED("Debug points queue capacity reached! Dropping further debug point draws.");
+            break;
+        }
 
-    // Issue the render calls:
-    if (flags & FlushLines)  { drawDebugLines(DD_EXPLICIT_CONTEXT_ONLY(ctx));   }
-    if (flags & FlushPoints) { drawDebugPoints(DD_EXPLICIT_CONTEXT_ONLY(ctx));  }
-    if (flags & FlushText)   { drawDebugStrings(DD_EXPLICIT_CONTEXT_ONLY(ctx)); }
+        const int first = chunk->count - 1;
+        const int n = 1 + queueAppend<DebugPointStreams>(queue, chunk, expiry, transient, count - accepted - 1);
+        const DebugPointStreams points(chunk, chunk->capacity);
 
-    // And cleanup if needed.
-    DD_CONTEXT->renderInterface->endDraw();
+        for (int i = first; i < first + n; ++i, ++accepted)
+        {
+            const float * const pos = stridedElement(positions, stride, accepted);
+            float * const p = &points.positions[i * 3];
+            p[0] = pos[0]; p[1] = pos[1]; p[2] = pos[2];
 
-    // Remove all expired objects, regardless of draw flags:
-    clearDebugQueue(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugStrings, DD_CONTEXT->debugStringsCount);
-    clearDebugQueue(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugPoints,  DD_CONTEXT->debugPointsCount);
-    clearDebugQueue(DD_EXPLICIT_CONTEXT_ONLY(ctx,) DD_CONTEXT->debugLines,   DD_CONTEXT->debugLinesCount);
+            points.colors[i] = (colorStride != 0) ? packStridedColor(colors, colorStride, accepted) : sharedColor;
+            points.sizes[i]  = size;
+        }
+    }
+    return accepted;
 }
 
-void clear(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx))
+void line(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In from, ddVec3_In to,
+          ddVec3_In color, const int durationMillis, const bool depthEnabled)
 {
     if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
     {
         return;
     }
 
-    // Let the user cleanup the debug strings:
-    #ifdef DEBUG_DRAW_STR_DEALLOC_FUNC
-    for (int i = 0; i < DEBUG_DRAW_MAX_STRINGS; ++i)
+    QueueChunk * const chunk = queuePushEvicting<DebugLineStreams>(&DD_CONTEXT->debugLines[0][0], 2, depthEnabled,
+                                                                   DD_CONTEXT->drawPriority,
+                                                                   DD_CONTEXT->currentTimeMillis + durationMillis,
+                                                                   durationMillis <= 0, DD_CONTEXT->evictionStats.evictedLines);
+    if (chunk == nullptr)
     {
-        DEBUG_DRAW_STR_DEALLOC_FUNC(DD_CONTEXT->debugStrings[i].text);
+        ++DD_CONTEXT->evictionStats.droppedLines;
+        DEBUG_DRAW_OVERFLOWED("Debug lines queue capacity reached! Dropping further debug line draws.");
+        return;
     }
-    #endif // DEBUG_DRAW_STR_DEALLOC_FUNC
 
-    DD_CONTEXT->vertexBufferUsed  = 0;
-    DD_CONTEXT->debugStringsCount = 0;
-    DD_CONTEXT->debugPointsCount  = 0;
-    DD_CONTEXT->debugLinesCount   = 0;
+    const DebugLineStreams lines(chunk, chunk->capacity);
+    const int i = chunk->count - 1;
+
+    lines.colors[i] = packColor(color);
+
+    float * const p = &lines.positions[i * 6];
+    p[0] = from[X]; p[1] = from[Y]; p[2] = from[Z];
+    p[3] = to[X];   p[4] = to[Y];   p[5] = to[Z];
 }
 
-void point(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In pos, ddVec3_In color,
-           const float size, const int durationMillis, const bool depthEnabled)
+int lines(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * const from, const float * const to,
+          const int stride, const int count, const float * const colors, const int colorStride,
+          const int durationMillis, const bool depthEnabled)
 {
-    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)) || from == nullptr || to == nullptr ||
+        colors == nullptr || count <= 0)
     {
-        return;
+        return 0;
     }
 
-    if (DD_CONTEXT->debugPointsCount == DEBUG_DRAW_MAX_POINTS)
+    const std::int64_t  expiry      = DD_CONTEXT->currentTimeMillis + durationMillis;
+    const bool          transient   = (durationMillis <= 0);
+    const std::uint32_t sharedColor = packStridedColor(colors, 0, 0);
+    DebugQueue & queue = DD_CONTEXT->debugLines[DD_CONTEXT->drawPriority][depthEnabled];
+
+    // One push per chunk, which takes care of the eviction, then fill the rest of the chunk.
+    int accepted = 0;
+    while (accepted < count)
     {
-        DEBUG_DRAW_OVERFLOWED("DEBUG_DRAW_MAX_POINTS limit reached! Dropping further debug point draws.");
-        return;
-    }
+        QueueChunk * const chunk = queuePushEvicting<DebugLineStreams>(&DD_CONTEXT->debugLines[0][0], 2, depthEnabled,
+                                                                       DD_CONTEXT->drawPriority, expiry, transient,
+                                                                       DD_CONTEXT->evictionStats.evictedLines);
+        if (chunk == nullptr)
+        {
+            DD_CONTEXT->evictionStats.droppedLines += count - accepted;
+            DEBUG_DRAW_OVERFLOWED("Debug lines queue capacity reached! Dropping further debug line draws.");
+            break;
+        }
+
+        const int first = chunk->count - 1;
+        const int n = 1 + queueAppend<DebugLineStreams>(queue, chunk, expiry, transient, count - accepted - 1);
+        const DebugLineStreams lines(chunk, chunk->capacity);
 
-    DebugPoint & point     = DD_CONTEXT->debugPoints[DD_CONTEXT->debugPointsCount++];
-    point.expiryDateMillis = DD_CONTEXT->currentTimeMillis + durationMillis;
-    point.depthEnabled     = depthEnabled;
-    point.size             = size;
+        for (int i = first; i < first + n; ++i, ++accepted)
+        {
+            const float * const a = stridedElement(from, stride, accepted);
+            const float * const b = stridedElement(to,   stride, accepted);
+            float * const p = &lines.positions[i * 6];
+            p[0] = a[0]; p[1] = a[1]; p[2] = a[2];
+            p[3] = b[0]; p[4] = b[1]; p[5] = b[2];
 
-    vecCopy(point.position, pos);
-    vecCopy(point.color, color);
+            lines.colors[i] = (colorStride != 0) ? packStridedColor(colors, colorStride, accepted) : sharedColor;
+        }
+    }
+    return accepted;
 }
 
-void line(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In from, ddVec3_In to,
-          ddVec3_In color, const int durationMillis, const bool depthEnabled)
+void polyline(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const ddVec3 * points, const int count,
+              ddVec3_In color, const int durationMillis, const bool depthEnabled)
 {
-    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)) || points == nullptr || count < 2)
     {
         return;
     }
 
-    if (DD_CONTEXT->debugLinesCount == DEBUG_DRAW_MAX_LINES)
+    std::uint16_t * indexes;
+    float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) count, 0, color,
+                                            durationMillis, depthEnabled, indexes);
+    if (positions == nullptr)
     {
-        DEBUG_DRAW_OVERFLOWED("DEBUG_DRAW_MAX_LINES limit reached! Dropping further debug line draws.");
         return;
     }
 
-    DebugLine & line      = DD_CONTEXT->debugLines[DD_CONTEXT->debugLinesCount++];
-    line.expiryDateMillis = DD_CONTEXT->currentTimeMillis + durationMillis;
-    line.depthEnabled     = depthEnabled;
-
-    vecCopy(line.posFrom, from);
-    vecCopy(line.posTo, to);
-    vecCopy(line.color, color);
+    for (int i = 0; i < count; ++i)
+    {
+        vecCopy(&positions[i * 3], points[i]);
+    }
 }
 
 void screenText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * const str, ddVec3_In pos,
@@ -2709,20 +6798,7 @@ void screenText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * const
         return;
     }
 
-    if (DD_CONTEXT->debugStringsCount == DEBUG_DRAW_MAX_STRINGS)
-    {
-        DEBUG_DRAW_OVERFLOWED("DEBUG_DRAW_MAX_STRINGS limit reached! Dropping further debug string draws.");
-        return;
-    }
-
-    DebugString & dstr    = DD_CONTEXT->debugStrings[DD_CONTEXT->debugStringsCount++];
-    dstr.expiryDateMillis = DD_CONTEXT->currentTimeMillis + durationMillis;
-    dstr.posX             = pos[X];
-    dstr.posY             = pos[Y];
-    dstr.scaling          = scaling;
-    dstr.text             = str;
-    dstr.centered         = false;
-    vecCopy(dstr.color, color);
+    pushDebugString(DD_EXPLICIT_CONTEXT_ONLY(ctx,) str, pos[X], pos[Y], color, scaling, durationMillis, false);
 }
 
 void projectedText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * const str, ddVec3_In pos, ddVec3_In color,
@@ -2739,12 +6815,6 @@ void projectedText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * con
         return;
     }
 
-    if (DD_CONTEXT->debugStringsCount == DEBUG_DRAW_MAX_STRINGS)
-    {
-        DEBUG_DRAW_OVERFLOWED("DEBUG_DRAW_MAX_STRINGS limit reached! Dropping further debug string draws.");
-        return;
-    }
-
     float tempPoint[4];
     matTransformPointXYZW(tempPoint, pos, vpMatrix);
 
@@ -2772,14 +6842,7 @@ void projectedText(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const char * con
     // NOTE: This is not renderer agnostic, I think... Should add a #define or something!
     scrY = static_cast<float>(sh) - scrY;
 
-    DebugString & dstr    = DD_CONTEXT->debugStrings[DD_CONTEXT->debugStringsCount++];
-    dstr.expiryDateMillis = DD_CONTEXT->currentTimeMillis + durationMillis;
-    dstr.posX             = scrX;
-    dstr.posY             = scrY;
-    dstr.scaling          = scaling;
-    dstr.text             = str;
-    dstr.centered         = true;
-    vecCopy(dstr.color, color);
+    pushDebugString(DD_EXPLICIT_CONTEXT_ONLY(ctx,) str, scrX, scrY, color, scaling, durationMillis, true);
 }
 
 void axisTriad(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddMat4x4_In transform, const float size,
@@ -2791,22 +6854,26 @@ void axisTriad(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddMat4x4_In transfor
     }
 
     ddVec3 p0, p1, p2, p3;
-    ddVec3 xEnd, yEnd, zEnd;
-    ddVec3 origin, cR, cG, cB;
+    ddVec3 cR, cG, cB;
 
     vecSet(cR, 1.0f, 0.0f, 0.0f);
     vecSet(cG, 0.0f, 1.0f, 0.0f);
     vecSet(cB, 0.0f, 0.0f, 1.0f);
 
-    vecSet(origin, 0.0f, 0.0f, 0.0f);
-    vecSet(xEnd, length, 0.0f, 0.0f);
-    vecSet(yEnd, 0.0f, length, 0.0f);
-    vecSet(zEnd, 0.0f, 0.0f, length);
+    // Origin and the ends of the X, Y and Z axes, transformed together:
+    const float ends[4][3] = {
+        { 0.0f,   0.0f,   0.0f   },
+        { length, 0.0f,   0.0f   },
+        { 0.0f,   length, 0.0f   },
+        { 0.0f,   0.0f,   length }
+    };
+    float transformed[4][4];
+    transformPoints(&transformed[0][0], &ends[0][0], 4, transform);
 
-    matTransformPointXYZ(p0, origin, transform);
-    matTransformPointXYZ(p1, xEnd, transform);
-    matTransformPointXYZ(p2, yEnd, transform);
-    matTransformPointXYZ(p3, zEnd, transform);
+    vecSet(p0, transformed[0][X], transformed[0][Y], transformed[0][Z]);
+    vecSet(p1, transformed[1][X], transformed[1][Y], transformed[1][Z]);
+    vecSet(p2, transformed[2][X], transformed[2][Y], transformed[2][Z]);
+    vecSet(p3, transformed[3][X], transformed[3][Y], transformed[3][Z]);
 
     arrow(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p0, p1, cR, size, durationMillis, depthEnabled); // X: red axis
     arrow(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p0, p2, cG, size, durationMillis, depthEnabled); // Y: green axis
@@ -2821,7 +6888,7 @@ void arrow(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In from, ddVec3_I
         return;
     }
 
-    static const float arrowStep = 30.0f; // In degrees
+    static const int arrowSteps = 12; // One every 30 degrees
     static const float arrowSin[45] = {
         0.0f, 0.5f, 0.866025f, 1.0f, 0.866025f, 0.5f, -0.0f, -0.5f, -0.866025f,
         -1.0f, -0.866025f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
@@ -2846,8 +6913,12 @@ void arrow(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In from, ddVec3_I
     vecScale(forward, forward, size);
 
     // Arrowhead is a cone (sin/cos tables used here):
-    float degrees = 0.0f;
-    for (int i = 0; degrees < 360.0f; degrees += arrowStep, ++i)
+    ddVec3 headBase;
+    vecSub(headBase, to, forward);
+    const int stride = lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) headBase, 0.5f * size, arrowSteps, 3);
+    countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) arrowSteps * 2, (arrowSteps / stride) * 2);
+
+    for (int i = 0; i < arrowSteps; i += stride)
     {
         float scale;
         ddVec3 v1, v2, temp;
@@ -2861,12 +6932,12 @@ void arrow(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In from, ddVec3_I
         vecScale(temp, up, scale);
         vecAdd(v1, v1, temp);
 
-        scale = 0.5f * size * arrowCos[i + 1];
+        scale = 0.5f * size * arrowCos[i + stride];
         vecScale(temp, right, scale);
         vecSub(v2, to, forward);
         vecAdd(v2, v2, temp);
 
-        scale = 0.5f * size * arrowSin[i + 1];
+        scale = 0.5f * size * arrowSin[i + stride];
         vecScale(temp, up, scale);
         vecAdd(v2, v2, temp);
 
@@ -2928,19 +6999,51 @@ void circle(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec
     vecScale(left, left, radius);
     vecAdd(lastPoint, center, up);
 
-    for (int i = 1; i <= numSteps; ++i)
+    // Never more steps than asked for, but as few as the level of detail allows.
+    float steps = numSteps;
+    float minSteps;
+    if (lodMinSteps(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, radius, minSteps) && minSteps < numSteps)
     {
-        const float radians = TAU * i / numSteps;
+        const int lodSteps = (static_cast<int>(minSteps) + 1 > LodMinSteps) ? static_cast<int>(minSteps) + 1 : LodMinSteps;
+        if (lodSteps < static_cast<int>(numSteps))
+        {
+            countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) static_cast<int>(numSteps), lodSteps);
+            steps = static_cast<float>(lodSteps);
+        }
+    }
 
-        ddVec3 vs, vc;
-        vecScale(vs, left, floatSin(radians));
-        vecScale(vc, up,   floatCos(radians));
+    // The step count is arbitrary, so rather than a table lookup each
+    // step rotates the previous (sin, cos) pair by the step angle.
+    const float stepSin = floatSin(TAU / steps);
+    const float stepCos = floatCos(TAU / steps);
+    float s = 0.0f;
+    float c = 1.0f;
 
-        vecAdd(point, center, vs);
-        vecAdd(point, point,  vc);
+    // The points are computed a block at a time, from the (sin, cos) pairs of the block.
+    static const int blockSize = 32;
+    float sines[blockSize], cosines[blockSize];
+    float points[blockSize * 3];
+
+    const int numLines = (steps >= 1.0f) ? static_cast<int>(steps) : 0;
+    for (int first = 0; first < numLines; first += blockSize)
+    {
+        const int count = (numLines - first < blockSize) ? (numLines - first) : blockSize;
+        for (int i = 0; i < count; ++i)
+        {
+            const float prevS = s;
+            s = prevS * stepCos + c * stepSin;
+            c = c * stepCos - prevS * stepSin;
+            sines[i]   = s;
+            cosines[i] = c;
+        }
+        ringPoints(points, center, left, up, sines, cosines, 1, count);
 
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastPoint, point, color, durationMillis, depthEnabled);
-        vecCopy(lastPoint, point);
+        for (int i = 0; i < count; ++i)
+        {
+            vecSet(point, points[i * 3], points[i * 3 + 1], points[i * 3 + 2]);
+            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastPoint, point, color, durationMillis, depthEnabled);
+            vecCopy(lastPoint, point);
+        }
     }
 }
 
@@ -2985,6 +7088,46 @@ void plane(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec3
     }
 }
 
+// Queues a sphere, as an instance of the unit sphere if the renderer takes
+// those. Returns false if it had to be dropped.
+static bool queueSphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, const std::uint32_t color,
+                        const float radius, const int durationMillis, const bool depthEnabled)
+{
+    if (DD_CONTEXT->shapeMeshes[ShapeMeshSphere] != nullptr)
+    {
+        float * const transform = queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ctx,) ShapeMeshSphere, color,
+                                                     durationMillis, depthEnabled);
+        if (transform == nullptr)
+        {
+            return false;
+        }
+
+        const ddVec3 xAxis = { radius, 0.0f, 0.0f };
+        const ddVec3 yAxis = { 0.0f, radius, 0.0f };
+        const ddVec3 zAxis = { 0.0f, 0.0f, radius };
+        setInstanceTransform(transform, xAxis, yAxis, zAxis, center);
+        return true;
+    }
+
+    // Coarser levels keep half as many rings as segments, down to an octahedron.
+    const int stride      = lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, radius, SphereNumSteps, 6);
+    const int numSegments = SphereNumSteps / stride;
+    const int numRings    = numSegments / 2 - 1;
+
+    std::uint16_t * indexes;
+    float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) sphereMeshVerts(numRings, numSegments),
+                                            sphereMeshIndexes(numRings, numSegments), color, durationMillis,
+                                            depthEnabled, indexes);
+    if (positions == nullptr)
+    {
+        return false;
+    }
+
+    writeSphereMesh(positions, indexes, center, radius, numRings, numSegments);
+    countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) SphereMeshIndexes / 2, sphereMeshIndexes(numRings, numSegments) / 2);
+    return true;
+}
+
 void sphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec3_In color,
             const float radius, const int durationMillis, const bool depthEnabled)
 {
@@ -2993,41 +7136,56 @@ void sphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec
         return;
     }
 
-    static const int stepSize = 15;
-    ddVec3 cache[360 / stepSize];
-    ddVec3 radiusVec;
+    queueSphere(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, packColor(color), radius, durationMillis, depthEnabled);
+}
+
+void latLongSphere(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec3_In color, const float radius,
+                   int numRings, int numSegments, const int durationMillis, const bool depthEnabled)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
 
-    vecSet(radiusVec, 0.0f, 0.0f, radius);
-    vecAdd(cache[0], center, radiusVec);
+    numRings    = (numRings < 1) ? 1 : (numRings > SphereMaxRings) ? SphereMaxRings : numRings;
+    numSegments = (numSegments < 3) ? 3 : (numSegments > SphereMaxSegments) ? SphereMaxSegments : numSegments;
 
-    for (int n = 1; n < arrayLength(cache); ++n)
+    std::uint16_t * indexes;
+    float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) sphereMeshVerts(numRings, numSegments),
+                                            sphereMeshIndexes(numRings, numSegments), color, durationMillis,
+                                            depthEnabled, indexes);
+    if (positions != nullptr)
     {
-        vecCopy(cache[n], cache[0]);
+        writeSphereMesh(positions, indexes, center, radius, numRings, numSegments);
     }
+}
 
-    ddVec3 lastPoint, temp;
-    for (int i = stepSize; i <= 360; i += stepSize)
+int spheres(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * const centers, const int centerStride,
+            const float * const radii, const int radiusStride, const int count, const float * const colors,
+            const int colorStride, const int durationMillis, const bool depthEnabled)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)) || centers == nullptr || radii == nullptr ||
+        colors == nullptr || count <= 0)
     {
-        const float s = floatSin(degreesToRadians(i));
-        const float c = floatCos(degreesToRadians(i));
+        return 0;
+    }
 
-        lastPoint[X] = center[X];
-        lastPoint[Y] = center[Y] + radius * s;
-        lastPoint[Z] = center[Z] + radius * c;
+    const std::uint32_t sharedColor = packStridedColor(colors, 0, 0);
+    for (int i = 0; i < count; ++i)
+    {
+        const float * const c = stridedElement(centers, centerStride, i);
+        ddVec3 center;
+        vecSet(center, c[0], c[1], c[2]);
 
-        for (int n = 0, j = stepSize; j <= 360; j += stepSize, ++n)
+        if (!queueSphere(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center,
+                         (colorStride != 0) ? packStridedColor(colors, colorStride, i) : sharedColor,
+                         *stridedElement(radii, radiusStride, i), durationMillis, depthEnabled))
         {
-            temp[X] = center[X] + floatSin(degreesToRadians(j)) * radius * s;
-            temp[Y] = center[Y] + floatCos(degreesToRadians(j)) * radius * s;
-            temp[Z] = lastPoint[Z];
-
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastPoint, temp, color, durationMillis, depthEnabled);
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastPoint, cache[n], color, durationMillis, depthEnabled);
-
-            vecCopy(cache[n], lastPoint);
-            vecCopy(lastPoint, temp);
+            DD_CONTEXT->evictionStats.droppedMeshes += count - i - 1; // The rest are not tried.
+            return i;
         }
     }
+    return count;
 }
 
 void cone(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In apex, ddVec3_In dir, ddVec3_In color,
@@ -3038,10 +7196,8 @@ void cone(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In apex, ddVec3_In
         return;
     }
 
-    static const int stepSize = 20;
     ddVec3 axis[3];
-    ddVec3 top, temp0, temp1, temp2;
-    ddVec3 p1, p2, lastP1, lastP2;
+    ddVec3 top, temp1, temp2;
 
     vecCopy(axis[2], dir);
     vecNormalize(axis[2], axis[2]);
@@ -3052,64 +7208,113 @@ void cone(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In apex, ddVec3_In
     axis[1][Z] = -axis[1][Z];
 
     vecAdd(top, apex, dir);
-    vecScale(temp1, axis[1], baseRadius);
-    vecAdd(lastP2, top, temp1);
 
+    // The widest of the two circles decides the level of detail.
+    const int stride = (baseRadius >= apexRadius)
+                     ? lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) top,  baseRadius, ConeNumSteps, 3)
+                     : lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) apex, apexRadius, ConeNumSteps, 3);
+    const int numSteps = ConeNumSteps / stride;
+
+    std::uint16_t * indexes;
     if (apexRadius == 0.0f)
     {
-        for (int i = stepSize; i <= 360; i += stepSize)
+        if (DD_CONTEXT->shapeMeshes[ShapeMeshCone] != nullptr)
         {
-            vecScale(temp1, axis[0], floatSin(degreesToRadians(i)));
-            vecScale(temp2, axis[1], floatCos(degreesToRadians(i)));
-            vecAdd(temp0, temp1, temp2);
-
-            vecScale(temp0, temp0, baseRadius);
-            vecAdd(p2, top, temp0);
-
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastP2, p2, color, durationMillis, depthEnabled);
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p2, apex, color, durationMillis, depthEnabled);
+            float * const transform = queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ctx,) ShapeMeshCone, color,
+                                                         durationMillis, depthEnabled);
+            if (transform != nullptr)
+            {
+                vecScale(temp1, axis[0], baseRadius);
+                vecScale(temp2, axis[1], baseRadius);
+                setInstanceTransform(transform, temp1, temp2, dir, apex);
+            }
+            return;
+        }
 
-            vecCopy(lastP2, p2);
+        float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) 2 + numSteps, numSteps * 4,
+                                                color, durationMillis, depthEnabled, indexes);
+        if (positions != nullptr)
+        {
+            writeConeMesh(positions, indexes, apex, top, axis, baseRadius, stride);
+            countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) ConeNumSteps * 2, numSteps * 2);
         }
     }
     else // A degenerate cone with open apex:
     {
-        vecScale(temp1, axis[1], apexRadius);
-        vecAdd(lastP1, apex, temp1);
-
-        for (int i = stepSize; i <= 360; i += stepSize)
+        // The apex circle, then the base circle, both closed by a repeat of their first vertex.
+        float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) 2 + numSteps * 2, numSteps * 6,
+                                                color, durationMillis, depthEnabled, indexes);
+        if (positions == nullptr)
         {
-            vecScale(temp1, axis[0], floatSin(degreesToRadians(i)));
-            vecScale(temp2, axis[1], floatCos(degreesToRadians(i)));
-            vecAdd(temp0, temp1, temp2);
+            return;
+        }
+        countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) ConeNumSteps * 3, numSteps * 3);
 
-            vecScale(temp1, temp0, apexRadius);
-            vecScale(temp2, temp0, baseRadius);
+        const SinCosTable<ConeStepSize> & table = sinCosTable<ConeStepSize>();
+        const int ringVerts = numSteps + 1;
 
-            vecAdd(p1, apex, temp1);
-            vecAdd(p2, top,  temp2);
+        vecScale(temp1, axis[0], apexRadius);
+        vecScale(temp2, axis[1], apexRadius);
+        ringPoints(positions, apex, temp1, temp2, table.sin, table.cos, stride, ringVerts);
 
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastP1, p1, color, durationMillis, depthEnabled);
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) lastP2, p2, color, durationMillis, depthEnabled);
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p1, p2, color, durationMillis, depthEnabled);
+        vecScale(temp1, axis[0], baseRadius);
+        vecScale(temp2, axis[1], baseRadius);
+        ringPoints(&positions[ringVerts * 3], top, temp1, temp2, table.sin, table.cos, stride, ringVerts);
 
-            vecCopy(lastP1, p1);
-            vecCopy(lastP2, p2);
+        for (int n = 1; n <= numSteps; ++n)
+        {
+            addMeshLine(indexes, n - 1, n);
+            addMeshLine(indexes, ringVerts + n - 1, ringVerts + n);
+            addMeshLine(indexes, n, ringVerts + n);
         }
     }
 }
 
+// Box line mesh from its eight corners. Returns false if it had to be dropped.
+static bool queueBoxMesh(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const ddVec3 points[8], const std::uint32_t color,
+                         const int durationMillis, const bool depthEnabled)
+{
+    std::uint16_t * indexes;
+    float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) BoxMeshVerts, BoxMeshIndexes, color,
+                                            durationMillis, depthEnabled, indexes);
+    if (positions == nullptr)
+    {
+        return false;
+    }
+
+    writeBoxMesh(positions, indexes, points);
+    return true;
+}
+
 void box(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const ddVec3 points[8], ddVec3_In color,
          const int durationMillis, const bool depthEnabled)
 {
-    // Build the lines from points using clever indexing tricks:
-    // (& 3 is a fancy way of doing % 4, but avoids the expensive modulo operation)
-    for (int i = 0; i < 4; ++i)
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    queueBoxMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, packColor(color), durationMillis, depthEnabled);
+}
+
+// Axis aligned box, as an instance of the unit cube if the renderer takes those.
+// Returns false if it had to be dropped.
+static bool axisAlignedBox(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, const std::uint32_t color,
+                           const float width, const float height, const float depth, const int durationMillis,
+                           const bool depthEnabled)
+{
+    float * const transform = queueShapeInstance(DD_EXPLICIT_CONTEXT_ONLY(ctx,) ShapeMeshBox, color,
+                                                 durationMillis, depthEnabled);
+    if (transform == nullptr)
     {
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points[i], points[(i + 1) & 3], color, durationMillis, depthEnabled);
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points[4 + i], points[4 + ((i + 1) & 3)], color, durationMillis, depthEnabled);
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points[i], points[4 + i], color, durationMillis, depthEnabled);
+        return false;
     }
+
+    const ddVec3 xAxis = { width, 0.0f, 0.0f };
+    const ddVec3 yAxis = { 0.0f, height, 0.0f };
+    const ddVec3 zAxis = { 0.0f, 0.0f, depth };
+    setInstanceTransform(transform, xAxis, yAxis, zAxis, center);
+    return true;
 }
 
 void box(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec3_In color, const float width,
@@ -3120,38 +7325,32 @@ void box(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVec3_I
         return;
     }
 
-    const float cx = center[X];
-    const float cy = center[Y];
-    const float cz = center[Z];
-    const float w  = width  * 0.5f;
-    const float h  = height * 0.5f;
-    const float d  = depth  * 0.5f;
+    if (DD_CONTEXT->shapeMeshes[ShapeMeshBox] != nullptr)
+    {
+        axisAlignedBox(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, packColor(color), width, height, depth,
+                       durationMillis, depthEnabled);
+        return;
+    }
 
     // Create all the 8 points:
     ddVec3 points[8];
-    #define DD_BOX_V(v, op1, op2, op3) \
-    v[X] = cx op1 w; \
-    v[Y] = cy op2 h; \
-    v[Z] = cz op3 d
-    DD_BOX_V(points[0], -, +, +);
-    DD_BOX_V(points[1], -, +, -);
-    DD_BOX_V(points[2], +, +, -);
-    DD_BOX_V(points[3], +, +, +);
-    DD_BOX_V(points[4], -, -, +);
-    DD_BOX_V(points[5], -, -, -);
-    DD_BOX_V(points[6], +, -, -);
-    DD_BOX_V(points[7], +, -, +);
-    #undef DD_BOX_V
+    boxCorners(points, center, width, height, depth);
 
     box(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, color, durationMillis, depthEnabled);
 }
 
-void aabb(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In mins, ddVec3_In maxs,
-          ddVec3_In color, const int durationMillis, const bool depthEnabled)
+// Returns false if the box had to be dropped.
+static bool queueAabb(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In mins, ddVec3_In maxs,
+                      const std::uint32_t color, const int durationMillis, const bool depthEnabled)
 {
-    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    if (DD_CONTEXT->shapeMeshes[ShapeMeshBox] != nullptr)
     {
-        return;
+        ddVec3 center;
+        center[X] = (mins[X] + maxs[X]) * 0.5f;
+        center[Y] = (mins[Y] + maxs[Y]) * 0.5f;
+        center[Z] = (mins[Z] + maxs[Z]) * 0.5f;
+        return axisAlignedBox(DD_EXPLICIT_CONTEXT_ONLY(ctx,) center, color, maxs[X] - mins[X], maxs[Y] - mins[Y],
+                              maxs[Z] - mins[Z], durationMillis, depthEnabled);
     }
 
     ddVec3 bb[2];
@@ -3169,7 +7368,60 @@ void aabb(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In mins, ddVec3_In
     }
 
     // Build the lines:
-    box(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, color, durationMillis, depthEnabled);
+    return queueBoxMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) points, color, durationMillis, depthEnabled);
+}
+
+void aabb(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In mins, ddVec3_In maxs,
+          ddVec3_In color, const int durationMillis, const bool depthEnabled)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)))
+    {
+        return;
+    }
+
+    queueAabb(DD_EXPLICIT_CONTEXT_ONLY(ctx,) mins, maxs, packColor(color), durationMillis, depthEnabled);
+}
+
+int aabbs(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) const float * const mins, const float * const maxs,
+          const int stride, const int count, const float * const colors, const int colorStride,
+          const int durationMillis, const bool depthEnabled)
+{
+    if (!isInitialized(DD_EXPLICIT_CONTEXT_ONLY(ctx)) || mins == nullptr || maxs == nullptr ||
+        colors == nullptr || count <= 0)
+    {
+        return 0;
+    }
+
+    // Line meshes all have the same size, so their geometry can be reserved up front.
+    if (DD_CONTEXT->shapeMeshes[ShapeMeshBox] == nullptr)
+    {
+        const std::int64_t bytes = static_cast<std::int64_t>(count) *
+                                   arenaAllocBytes(lineMeshBytes(BoxMeshVerts, BoxMeshIndexes));
+        if (bytes < (1 << 28)) // Otherwise left to the per mesh checks, away from the int limits.
+        {
+            Arena & arena = (durationMillis <= 0) ? DD_CONTEXT->transientGeometry : DD_CONTEXT->timedGeometry;
+            arenaReserve(arena, *DD_CONTEXT->allocator, static_cast<int>(bytes));
+        }
+    }
+
+    const std::uint32_t sharedColor = packStridedColor(colors, 0, 0);
+    for (int i = 0; i < count; ++i)
+    {
+        const float * const lo = stridedElement(mins, stride, i);
+        const float * const hi = stridedElement(maxs, stride, i);
+        ddVec3 boxMins, boxMaxs;
+        vecSet(boxMins, lo[0], lo[1], lo[2]);
+        vecSet(boxMaxs, hi[0], hi[1], hi[2]);
+
+        if (!queueAabb(DD_EXPLICIT_CONTEXT_ONLY(ctx,) boxMins, boxMaxs,
+                       (colorStride != 0) ? packStridedColor(colors, colorStride, i) : sharedColor,
+                       durationMillis, depthEnabled))
+        {
+            DD_CONTEXT->evictionStats.droppedMeshes += count - i - 1; // The rest are not tried.
+            return i;
+        }
+    }
+    return count;
 }
 
 void frustum(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddMat4x4_In invClipMatrix,
@@ -3191,26 +7443,24 @@ void frustum(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddMat4x4_In invClipMat
     };
 
     ddVec3 points[8];
-    float wCoords[8];
+    float clipPoints[8][4];
 
     // Transform the planes by the inverse clip matrix:
-    for (int i = 0; i < arrayLength(planes); ++i)
-    {
-        wCoords[i] = matTransformPointXYZW2(points[i], planes[i], invClipMatrix);
-    }
+    transformPoints(&clipPoints[0][0], &planes[0][0], arrayLength(planes), invClipMatrix);
 
     // Divide by the W component of each:
     for (int i = 0; i < arrayLength(planes); ++i)
     {
         // But bail if any W ended up as zero.
-        if (floatAbs(wCoords[W]) < FloatEpsilon)
+        const float w = clipPoints[i][W];
+        if (floatAbs(w) < FloatEpsilon)
         {
             return;
         }
 
-        points[i][X] /= wCoords[i];
-        points[i][Y] /= wCoords[i];
-        points[i][Z] /= wCoords[i];
+        points[i][X] = clipPoints[i][X] / w;
+        points[i][Y] = clipPoints[i][Y] / w;
+        points[i][Z] = clipPoints[i][Z] / w;
     }
 
     // Connect the dots:
@@ -3301,13 +7551,12 @@ void capsule(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVe
     }
 
     // Normalize the axis vector
-    float magnitude = sqrt(axis[X] * axis[X] + axis[Y] * axis[Y] + axis[Z] * axis[Z]);
-    if (magnitude == 0.0f)
+    if ((axis[X] * axis[X] + axis[Y] * axis[Y] + axis[Z] * axis[Z]) == 0.0f)
     {
         return; // Invalid axis, exit gracefully
     }
     ddVec3 dir;
-    vecScale(dir, axis, 1.0f / magnitude);
+    vecNormalize(dir, axis);
 
     // Compute endpoints (centers of the hemispheres)
     ddVec3 temp;
@@ -3319,11 +7568,11 @@ void capsule(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVe
     // Find vectors u and v perpendicular to dir for the cross-section plane
     ddVec3 u, v, tempVec;
     // Choose a vector not parallel to dir
-    if (fabs(dir[X]) <= fabs(dir[Y]) && fabs(dir[X]) <= fabs(dir[Z]))
+    if (floatAbs(dir[X]) <= floatAbs(dir[Y]) && floatAbs(dir[X]) <= floatAbs(dir[Z]))
     {
         vecSet(tempVec, 1.0f, 0.0f, 0.0f);
     }
-    else if (fabs(dir[Y]) <= fabs(dir[Z]))
+    else if (floatAbs(dir[Y]) <= floatAbs(dir[Z]))
     {
         vecSet(tempVec, 0.0f, 1.0f, 0.0f);
     }
@@ -3332,117 +7581,118 @@ void capsule(DD_EXPLICIT_CONTEXT_ONLY(ContextHandle ctx,) ddVec3_In center, ddVe
         vecSet(tempVec, 0.0f, 0.0f, 1.0f);
     }
     vecCross(u, tempVec, dir);
-    float uMag = sqrt(u[X] * u[X] + u[Y] * u[Y] + u[Z] * u[Z]);
-    vecScale(u, u, 1.0f / uMag);
+    vecNormalize(u, u);
     vecCross(v, dir, u); // v is already unit length since dir and u are orthonormal
 
-    static const int stepSize = 15;
-
-    // Draw the cylinder
-    for (int j = 0; j < 360; j += stepSize)
-    {
-        float theta = degreesToRadians((float)j);
-        float theta2 = degreesToRadians((float)(j + stepSize));
-        ddVec3 point1, point2, point3, point4;
-
-        float c = floatCos(theta);
-        float s = floatSin(theta);
-        float c2 = floatCos(theta2);
-        float s2 = floatSin(theta2);
-
-        // Circle at p1
-        vecSet(point1, p1[X] + radius * (c * u[X] + s * v[X]),
-            p1[Y] + radius * (c * u[Y] + s * v[Y]),
-            p1[Z] + radius * (c * u[Z] + s * v[Z]));
-        vecSet(point2, p1[X] + radius * (c2 * u[X] + s2 * v[X]),
-            p1[Y] + radius * (c2 * u[Y] + s2 * v[Y]),
-            p1[Z] + radius * (c2 * u[Z] + s2 * v[Z]));
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point2, color, durationMillis, depthEnabled);
-
-        // Circle at p2
-        vecSet(point3, p2[X] + radius * (c * u[X] + s * v[X]),
-            p2[Y] + radius * (c * u[Y] + s * v[Y]),
-            p2[Z] + radius * (c * u[Z] + s * v[Z]));
-        vecSet(point4, p2[X] + radius * (c2 * u[X] + s2 * v[X]),
-            p2[Y] + radius * (c2 * u[Y] + s2 * v[Y]),
-            p2[Z] + radius * (c2 * u[Z] + s2 * v[Z]));
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point3, point4, color, durationMillis, depthEnabled);
+    // The nearest hemisphere decides the level of detail. Strides up
+    // to 3 keep a ring at both the rim and the tip of the hemispheres.
+    static const int stepSize  = 15;
+    static const int fullSteps = SinCosTable<stepSize>::NumSteps;
+    const int stride1   = lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p1, radius, fullSteps, 3);
+    const int stride2   = lodStride(DD_EXPLICIT_CONTEXT_ONLY(ctx,) p2, radius, fullSteps, 3);
+    const int stride    = (stride1 < stride2) ? stride1 : stride2;
+    const int numSteps  = fullSteps / stride;
+    const int numRings  = 90 / (stepSize * stride) + 1; // Per hemisphere, from the rim to the tip.
+    const int ringVerts = numSteps + 1;                 // The last one closes the ring.
+
+    // The vertexes are the cylinder circles at p1 and p2, followed
+    // by the rings of the hemisphere at p1 then the one at p2.
+    std::uint16_t * indexes;
+    float * const positions = queueLineMesh(DD_EXPLICIT_CONTEXT_ONLY(ctx,) (2 + 2 * numRings) * ringVerts,
+                                            (3 * numSteps + 2 * (2 * numRings - 1) * numSteps) * 2,
+                                            color, durationMillis, depthEnabled, indexes);
+    if (positions == nullptr)
+    {
+        return;
+    }
+    countLodSaving(DD_EXPLICIT_CONTEXT_ONLY(ctx,) 3 * fullSteps + 2 * (2 * (90 / stepSize + 1) - 1) * fullSteps,
+                   3 * numSteps + 2 * (2 * numRings - 1) * numSteps);
+
+    const SinCosTable<stepSize> & table = sinCosTable<stepSize>();
+
+    // Draw the cylinder: circles at p1 and p2
+    ddVec3 sinAxis, cosAxis;
+    vecScale(sinAxis, v, radius);
+    vecScale(cosAxis, u, radius);
+    ringPoints(positions, p1, sinAxis, cosAxis, table.sin, table.cos, stride, ringVerts);
+    ringPoints(&positions[ringVerts * 3], p2, sinAxis, cosAxis, table.sin, table.cos, stride, ringVerts);
+
+    for (int n = 0; n < numSteps; ++n)
+    {
+        addMeshLine(indexes, n, n + 1);
+        addMeshLine(indexes, ringVerts + n, ringVerts + n + 1);
 
         // Connecting line between circles
-        line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point3, color, durationMillis, depthEnabled);
+        addMeshLine(indexes, n, ringVerts + n);
     }
 
-    // Draw hemisphere at p1 (dome along -dir)
+    // Draw the hemispheres at p1 (dome along -dir) and at p2 (dome along +dir)
     ddVec3 d1;
     vecScale(d1, dir, -1.0f); // Direction for p1 hemisphere
-    for (int i = 0; i <= 90; i += stepSize)
+    const float * const bases[2] = { p1, p2 };
+    const float * const domes[2] = { d1, dir };
+
+    int ring = 2 * ringVerts;
+    for (int h = 0; h < 2; ++h)
     {
-        float phi = degreesToRadians((float)i);
-        float s = floatSin(phi);
-        float c = floatCos(phi);
+        const float * const base = bases[h];
+        const float * const dome = domes[h];
 
-        for (int j = 0; j < 360; j += stepSize)
+        for (int i = 0; i < numRings; ++i, ring += ringVerts)
         {
-            float theta = degreesToRadians((float)j);
-            float theta2 = degreesToRadians((float)(j + stepSize));
-            ddVec3 point1, point2;
-
-            vecSet(point1, p1[X] + radius * (s * floatCos(theta) * u[X] + s * floatSin(theta) * v[X] + c * d1[X]),
-                p1[Y] + radius * (s * floatCos(theta) * u[Y] + s * floatSin(theta) * v[Y] + c * d1[Y]),
-                p1[Z] + radius * (s * floatCos(theta) * u[Z] + s * floatSin(theta) * v[Z] + c * d1[Z]));
-            vecSet(point2, p1[X] + radius * (s * floatCos(theta2) * u[X] + s * floatSin(theta2) * v[X] + c * d1[X]),
-                p1[Y] + radius * (s * floatCos(theta2) * u[Y] + s * floatSin(theta2) * v[Y] + c * d1[Y]),
-                p1[Z] + radius * (s * floatCos(theta2) * u[Z] + s * floatSin(theta2) * v[Z] + c * d1[Z]));
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point2, color, durationMillis, depthEnabled);
-
-            if (i < 90)
+            // Ring of radius 'radius * sin(phi)', 'radius * cos(phi)' away from the base along the dome.
+            const float ringRadius = radius * table.sin[i * stride];
+            ddVec3 ringCenter;
+            vecScale(ringCenter, dome, radius * table.cos[i * stride]);
+            vecAdd(ringCenter, base, ringCenter);
+            vecScale(sinAxis, v, ringRadius);
+            vecScale(cosAxis, u, ringRadius);
+            ringPoints(&positions[ring * 3], ringCenter, sinAxis, cosAxis, table.sin, table.cos, stride, ringVerts);
+
+            for (int n = 0; n < numSteps; ++n)
             {
-                float phi2 = degreesToRadians((float)(i + stepSize));
-                float s2 = floatSin(phi2);
-                float c2 = floatCos(phi2);
-                ddVec3 point3;
-                vecSet(point3, p1[X] + radius * (s2 * floatCos(theta) * u[X] + s2 * floatSin(theta) * v[X] + c2 * d1[X]),
-                    p1[Y] + radius * (s2 * floatCos(theta) * u[Y] + s2 * floatSin(theta) * v[Y] + c2 * d1[Y]),
-                    p1[Z] + radius * (s2 * floatCos(theta) * u[Z] + s2 * floatSin(theta) * v[Z] + c2 * d1[Z]));
-                line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point3, color, durationMillis, depthEnabled);
+                addMeshLine(indexes, ring + n, ring + n + 1);
+                if (i < numRings - 1)
+                {
+                    addMeshLine(indexes, ring + n, ring + ringVerts + n);
+                }
             }
         }
     }
+}
 
-    // Draw hemisphere at p2 (dome along +dir)
-    for (int i = 0; i <= 90; i += stepSize)
-    {
-        float phi = degreesToRadians((float)i);
-        float s = floatSin(phi);
-        float c = floatCos(phi);
+// ========================================================
+// Allocator defaults:
+// ========================================================
 
-        for (int j = 0; j < 360; j += stepSize)
-        {
-            float theta = degreesToRadians((float)j);
-            float theta2 = degreesToRadians((float)(j + stepSize));
-            ddVec3 point1, point2;
+Allocator::~Allocator() { }
 
-            vecSet(point1, p2[X] + radius * (s * floatCos(theta) * u[X] + s * floatSin(theta) * v[X] + c * dir[X]),
-                p2[Y] + radius * (s * floatCos(theta) * u[Y] + s * floatSin(theta) * v[Y] + c * dir[Y]),
-                p2[Z] + radius * (s * floatCos(theta) * u[Z] + s * floatSin(theta) * v[Z] + c * dir[Z]));
-            vecSet(point2, p2[X] + radius * (s * floatCos(theta2) * u[X] + s * floatSin(theta2) * v[X] + c * dir[X]),
-                p2[Y] + radius * (s * floatCos(theta2) * u[Y] + s * floatSin(theta2) * v[Y] + c * dir[Y]),
-                p2[Z] + radius * (s * floatCos(theta2) * u[Z] + s * floatSin(theta2) * v[Z] + c * dir[Z]));
-            line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point2, color, durationMillis, depthEnabled);
+void * Allocator::allocate(const std::size_t size, std::size_t)
+{
+    return DD_MALLOC(size);
+}
 
-            if (i < 90)
-            {
-                float phi2 = degreesToRadians((float)(i + stepSize));
-                float s2 = floatSin(phi2);
-                float c2 = floatCos(phi2);
-                ddVec3 point3;
-                vecSet(point3, p2[X] + radius * (s2 * floatCos(theta) * u[X] + s2 * floatSin(theta) * v[X] + c2 * dir[X]),
-                    p2[Y] + radius * (s2 * floatCos(theta) * u[Y] + s2 * floatSin(theta) * v[Y] + c2 * dir[Y]),
-                    p2[Z] + radius * (s2 * floatCos(theta) * u[Z] + s2 * floatSin(theta) * v[Z] + c2 * dir[Z]));
-                line(DD_EXPLICIT_CONTEXT_ONLY(ctx,) point1, point3, color, durationMillis, depthEnabled);
-            }
-        }
+void Allocator::deallocate(void * ptr, std::size_t)
+{
+    DD_MFREE(ptr);
+}
+
+void * Allocator::reallocate(void * ptr, const std::size_t oldSize, const std::size_t newSize, const std::size_t alignment)
+{
+    void * newPtr = allocate(newSize, alignment);
+    if (newPtr == nullptr)
+    {
+        return nullptr;
     }
+
+    const std::size_t count = (oldSize < newSize) ? oldSize : newSize;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        static_cast<std::uint8_t *>(newPtr)[i] = static_cast<const std::uint8_t *>(ptr)[i];
+    }
+
+    deallocate(ptr, oldSize);
+    return newPtr;
 }
 
 // ========================================================
@@ -3455,6 +7705,36 @@ void RenderInterface::endDraw()
 void RenderInterface::drawPointList(const DrawVertex *, int, bool)               { }
 void RenderInterface::drawLineList(const DrawVertex *, int, bool)                { }
 void RenderInterface::drawGlyphList(const DrawVertex *, int, GlyphTextureHandle) { }
+bool RenderInterface::drawGlyphInstances(const GlyphInstance *, int, GlyphTextureHandle) { return false; }
+void RenderInterface::drawPointListCompact(const CompactPointVertex *, int, bool) { }
+void RenderInterface::drawLineListCompact(const CompactVertex *, int, bool)       { }
+void RenderInterface::drawPointListHalf(const HalfVertex *, int, bool)            { }
+void RenderInterface::drawLineListHalf(const HalfVertex *, int, bool)             { }
+void RenderInterface::drawPointQuads(const DrawVertex *, int, bool)               { }
+void RenderInterface::drawPointQuadsCompact(const CompactVertex *, int, bool)     { }
+void RenderInterface::drawPointQuadsHalf(const HalfVertex *, int, bool)           { }
+bool RenderInterface::drawIndexedLineList(const DrawVertex *, int, const std::uint16_t *, int, bool)           { return false; }
+bool RenderInterface::drawIndexedLineListCompact(const CompactVertex *, int, const std::uint16_t *, int, bool) { return false; }
+bool RenderInterface::drawIndexedLineListHalf(const HalfVertex *, int, const std::uint16_t *, int, bool)       { return false; }
+bool RenderInterface::drawLineStrip(const DrawVertex *, int, bool)               { return false; }
+bool RenderInterface::drawLineStripCompact(const CompactVertex *, int, bool)     { return false; }
+bool RenderInterface::drawLineStripHalf(const HalfVertex *, int, bool)           { return false; }
+#ifdef DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+void RenderInterface::drawPointListCustom(const CustomVertex *, int, bool)               { }
+void RenderInterface::drawLineListCustom(const CustomVertex *, int, bool)                { }
+void RenderInterface::drawGlyphListCustom(const CustomVertex *, int, GlyphTextureHandle) { }
+void RenderInterface::drawPointQuadsCustom(const CustomVertex *, int, bool)              { }
+bool RenderInterface::drawIndexedLineListCustom(const CustomVertex *, int, const std::uint16_t *, int, bool) { return false; }
+bool RenderInterface::drawLineStripCustom(const CustomVertex *, int, bool)               { return false; }
+#endif // DEBUG_DRAW_CUSTOM_VERTEX_TYPE
+void RenderInterface::drawShapeInstances(ShapeMeshHandle, const ShapeInstance *, int, bool)                { }
+bool RenderInterface::drawPersistentRange(std::uint32_t, std::uint32_t, const void *, int, bool)          { return false; }
+void RenderInterface::releasePersistentRange(std::uint32_t)                                               { }
+void RenderInterface::destroyShapeMesh(ShapeMeshHandle)                                                    { }
+ShapeMeshHandle RenderInterface::createShapeMesh(ShapeMesh, const float *, int, const std::uint16_t *, int) { return nullptr; }
+void * RenderInterface::acquireVertexSpace(DrawMode, bool, int)                  { return nullptr; }
+void RenderInterface::commitVertexSpace(DrawMode, bool, int)                     { }
+void RenderInterface::waitBufferConsumed(const void *)                           { }
 void RenderInterface::destroyGlyphTexture(GlyphTextureHandle)                    { }
 GlyphTextureHandle RenderInterface::createGlyphTexture(int, int, const void *)   { return nullptr; }
 